@@ -2,17 +2,33 @@
 
 #include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_precision.hpp>
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <limits>
+#include <cstddef>
 
 #include "Camera.h"
 #include "GLTFData.h"
-#include "Light.h"
 #include "GlGetError.h"
+#include "GlState.h"
+#include "TextureArrayPool.h"
+#include "TextureBuilder.h"
 
 //Static members
 std::unordered_map<std::string, AnimatedModel::ModelData> AnimatedModel::existingModels;
+std::vector<glm::mat4> AnimatedModel::framePalettes;
+size_t AnimatedModel::nUploadedPaletteMatrices = 0;
+std::vector<AnimatedModel::InstanceData> AnimatedModel::shadowCasters;
+const Shader* AnimatedModel::depthPrepassShader = nullptr;
+std::vector<AnimatedModel::InstanceData> AnimatedModel::skinningInstances;
+std::unique_ptr<Shader> AnimatedModel::skinningShader;
+size_t AnimatedModel::nSkinnedVertices = 0;
+size_t AnimatedModel::skinnedVertexCapacity = 0;
+unsigned int AnimatedModel::skinnedVertexBuffer = 0;
+unsigned int AnimatedModel::skinnedVertexTexture = 0;
 
 AnimatedModel::AnimatedModel(std::string name, const glm::mat4& ownerTransform, std::string animationName, std::string vertexShader, std::string fragShader)
 	:
@@ -74,112 +90,157 @@ void AnimatedModel::Update(float dt)
 
 void AnimatedModel::AddToRenderQueue(Camera& camera)
 {
-	//Store model matrix
-	const auto& modelTransform = ownerTransform;
-
-	//Calculate MVP
-	const auto& transform = camera.GetVPMatrix() * modelTransform;
-
-	//Gather joint transforms
-	std::vector<glm::mat4>& jointTransforms = pose;
-
-	modelData.renderQueue.push_back(std::make_tuple(modelTransform, transform, jointTransforms));
+	//Append pose to the joint palette of this frame, the instance only needs to remember where it starts
+	int paletteOffset = (int)framePalettes.size();
+	framePalettes.insert(framePalettes.end(), pose.begin(), pose.end());
+
+	//The MVP is calculated on the GPU
+	//Hidden instances still need their pose, they may cast a shadow into the view
+	const Animation& animation = modelData.animations.at(currentAnimation);
+	if (camera.IsInView(EliMath::TransformSphere(animation.boundingSphere, ownerTransform)))
+	{
+		modelData.renderQueue.push_back({ ownerTransform, paletteOffset });
+	}
+	else
+	{
+		modelData.culledQueue.push_back({ ownerTransform, paletteOffset });
+	}
 }
 
-void AnimatedModel::DrawAllInstances(const Light& light)
+void AnimatedModel::SubmitInstances(RenderQueue& renderQueue, StreamBuffer& streamBuffer)
 {
+	//Skin instances that were queued after the shadow pass
+	SkinInstances(streamBuffer);
+
 	for (std::pair<const std::string, ModelData>& element : existingModels)
 	{
 		ModelData& model = element.second;
 
-		//Bind shader
-		//REPLACE: literally all models use the same shader, might wanna reconsider this line of code
-		model.shader->Use();
+		//Models that aren't drawn this frame don't cost anything
+		if (!model.renderQueue.empty())
+		{
+			UploadInstances(model, model.renderQueue, streamBuffer);
+			renderQueue.SubmitOpaque(*model.shader, *depthPrepassShader, model.texture, model.vao, model.nIndices, model.renderQueue.size(),
+				GetNearestInstanceDistance(model, renderQueue.GetViewPos()));
+		}
 
-		GL_ERROR_CHECK();
+		//Clear renderqueue
+		model.renderQueue.clear();
+		model.culledQueue.clear();
+		model.nSkinnedVisible = 0;
+		model.nSkinnedCulled = 0;
+	}
+	GL_ERROR_CHECK();
 
-		//Bind texture
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, model.texture);
-		model.shader->SetUniformInt("tex", 0);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, light.GetShadowCubeMap());
-		model.shader->SetUniformInt("shadowCubeMap", 1);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, light.GetBakedShadowCubeMap());
-		model.shader->SetUniformInt("shadowCubeMapBaked", 2);
+	//Start a new palette and skinned vertex buffer next frame
+	framePalettes.clear();
+	nUploadedPaletteMatrices = 0;
+	nSkinnedVertices = 0;
+}
 
-		GL_ERROR_CHECK();
+void AnimatedModel::SubmitShadowCasters(RenderQueue& renderQueue, Light& light, StreamBuffer& streamBuffer)
+{
+	//Skin once, the colour pass reads the same skinned vertices
+	SkinInstances(streamBuffer);
 
-		//Bind vao
-		glBindVertexArray(model.vao);
+	for (std::pair<const std::string, ModelData>& element : existingModels)
+	{
+		ModelData& model = element.second;
 
-		//Draw instances
-		for (auto& instance : model.renderQueue)
+		//Instances outside of the view can still cast shadows into it, only the faces of the shadow cube map matter here
+		uint64_t modelHash = EliMath::HashBytes(element.first.data(), element.first.size());
+		shadowCasters.clear();
+		for (const std::vector<InstanceData>* queue : { &model.renderQueue, &model.culledQueue })
 		{
-			glm::mat4 modelTransform;
-			glm::mat4 transform;
-			std::vector<glm::mat4> jointTransforms;
-			std::tie(modelTransform, transform, jointTransforms) = instance;
-
-			model.shader->SetUniformMat4("model", modelTransform);
-			model.shader->SetUniformMat4("mvp", transform);
-			model.shader->SetUniformMat4Array("jointTransforms", jointTransforms);
-			model.shader->SetUniformFloat("lightFarPlane", light.GetFarPlane());
-			model.shader->SetUniformVec3("lightPos", light.GetPos());
-			GL_ERROR_CHECK();
-
-			glDrawElements(GL_TRIANGLES, (GLsizei)model.nIndices, GL_UNSIGNED_SHORT, 0);
-			GL_ERROR_CHECK();
-		}
-
-		//Unbind vao
-		glBindVertexArray(0);
+			for (const InstanceData& instance : *queue)
+			{
+				int faceMask = light.GetFaceMask(EliMath::TransformSphere(model.boundingSphere, instance.modelTransform));
+				if (faceMask != 0)
+				{
+					shadowCasters.push_back(instance);
+					shadowCasters.back().faceMask = faceMask;
 
-		//Clear renderqueue
-		model.renderQueue.clear();
+					//The pose changes the shadow just as much as the transform does
+					uint64_t casterHash = EliMath::HashBytes(&instance.modelTransform, sizeof(glm::mat4), modelHash);
+					casterHash = EliMath::HashBytes(&framePalettes[instance.paletteOffset], model.joints.size() * sizeof(glm::mat4), casterHash);
+					light.AddShadowCaster(faceMask, casterHash);
+				}
+			}
+		}
+		if (shadowCasters.empty())
+		{
+			continue;
+		}
 
-		GL_ERROR_CHECK();
+		//The queues are kept, the visible instances are drawn again in the colour pass
+		UploadInstances(model, shadowCasters, streamBuffer);
+		renderQueue.Submit(RenderPass::Shadow, light.GetAnimationShader(), 0, model.vao, model.nIndices, shadowCasters.size(), 0.0f);
 	}
+	GL_ERROR_CHECK();
 }
 
-void AnimatedModel::DrawShadows(const Light& light)
+void AnimatedModel::SkinInstances(StreamBuffer& streamBuffer)
 {
+	//Find out how many vertices the new instances need
+	size_t nNewVertices = 0;
 	for (std::pair<const std::string, ModelData>& element : existingModels)
 	{
-		ModelData& model = element.second;
+		const ModelData& model = element.second;
+		size_t nNewInstances = (model.renderQueue.size() - model.nSkinnedVisible) + (model.culledQueue.size() - model.nSkinnedCulled);
+		nNewVertices += nNewInstances * model.nVertices;
+	}
+	if (nNewVertices == 0)
+	{
+		return;
+	}
 
-		//Bind vao
-		glBindVertexArray(model.vao);
+	int paletteShift = UploadPalettes(streamBuffer);
+	ReserveSkinnedVertices(nSkinnedVertices + nNewVertices);
 
-		GL_ERROR_CHECK();
+	//Append to what was skinned earlier this frame, the output is only captured and never rasterized
+	skinningShader->Use();
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, skinnedVertexBuffer, nSkinnedVertices * skinnedVertexSize, nNewVertices * skinnedVertexSize);
+	glBeginTransformFeedback(GL_POINTS);
+	size_t vertexOffset = 0;	//Relative to the start of the bound range
+	for (std::pair<const std::string, ModelData>& element : existingModels)
+	{
+		ModelData& model = element.second;
 
-		//Draw instances
-		for (auto& instance : model.renderQueue)
+		//Every instance gets its own copy of the vertices, in the same order as they're uploaded
+		skinningInstances.clear();
+		for (size_t i = model.nSkinnedVisible; i < model.renderQueue.size(); i++)
 		{
-			glm::mat4 modelTransform;
-			glm::mat4 transform;
-			std::vector<glm::mat4> jointTransforms;
-			std::tie(modelTransform, transform, jointTransforms) = instance;
-
-			light.GetAnimationShader().SetUniformMat4("modelTransform", modelTransform);
-			light.GetAnimationShader().SetUniformMat4Array("jointTransforms", jointTransforms);
-			light.GetAnimationShader().SetUniformMat4Array("shadowMatrices", light.GetShadowMatrices());
-			light.GetAnimationShader().SetUniformVec3("lightPos", light.GetPos());
-			light.GetAnimationShader().SetUniformFloat("farPlane", light.GetFarPlane());
-
-			GL_ERROR_CHECK();
-
-			glDrawElements(GL_TRIANGLES, (GLsizei)model.nIndices, GL_UNSIGNED_SHORT, 0);
-			
-			GL_ERROR_CHECK();
+			model.renderQueue[i].vertexOffset = (int)(nSkinnedVertices + vertexOffset);
+			skinningInstances.push_back(model.renderQueue[i]);
+			skinningInstances.back().paletteOffset += paletteShift;
+			vertexOffset += model.nVertices;
+		}
+		for (size_t i = model.nSkinnedCulled; i < model.culledQueue.size(); i++)
+		{
+			model.culledQueue[i].vertexOffset = (int)(nSkinnedVertices + vertexOffset);
+			skinningInstances.push_back(model.culledQueue[i]);
+			skinningInstances.back().paletteOffset += paletteShift;
+			vertexOffset += model.nVertices;
+		}
+		model.nSkinnedVisible = model.renderQueue.size();
+		model.nSkinnedCulled = model.culledQueue.size();
+		if (skinningInstances.empty())
+		{
+			continue;
 		}
 
-		//Unbind vao
-		glBindVertexArray(0);
-
-		GL_ERROR_CHECK();
+		//Instanced draws are captured instance by instance, so instance i ends up at its vertexOffset
+		UploadInstances(model, skinningInstances, streamBuffer);
+		GlState::BindVertexArray(model.vao);
+		glDrawArraysInstanced(GL_POINTS, 0, (GLsizei)model.nVertices, (GLsizei)skinningInstances.size());
 	}
+	glEndTransformFeedback();
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glDisable(GL_RASTERIZER_DISCARD);
+	GlState::BindVertexArray(0);
+	nSkinnedVertices += nNewVertices;
+	GL_ERROR_CHECK();
 }
 
 void AnimatedModel::SetAnimation(std::string name)
@@ -252,7 +313,20 @@ AnimatedModel::ModelData& AnimatedModel::ConstructModelData(std::string name, st
 		auto& newModelData = existingModels[name];
 
 		//-------------------------Step 1: Make the shader-------------------------------------------------
-		newModelData.shader = std::make_unique<Shader>(vertexShader, fragShader);
+		newModelData.shader = &Shader::GetShared(vertexShader, fragShader);
+
+		//Texture units never change, so samplers only need to be set once per program
+		newModelData.shader->Use();
+		newModelData.shader->SetUniformInt("tex", 0);
+		newModelData.shader->SetUniformInt("shadowCubeMap", 1);
+		newModelData.shader->SetUniformInt("skinnedVertices", skinnedVertexTextureUnit);
+
+		if (!depthPrepassShader)
+		{
+			depthPrepassShader = &Shader::GetShared("DepthPrepassAnimation.vert", "DepthPrepass.frag");
+			depthPrepassShader->Use();
+			depthPrepassShader->SetUniformInt("skinnedVertices", skinnedVertexTextureUnit);
+		}
 
 		//-------------------------Step 2: Load the model using tinyGLTF-------------------------------------------------
 		//Import the model and check errors
@@ -299,7 +373,7 @@ AnimatedModel::ModelData& AnimatedModel::ConstructModelData(std::string name, st
 		//-------------------------Step 4: Set up vao,vbo,ebo and set up vertex attrib pointers-------------------------------------------------
 		//Generate VAO, VBO and EBO
 		glGenVertexArrays(1, &newModelData.vao);
-		glBindVertexArray(newModelData.vao);
+		GlState::BindVertexArray(newModelData.vao);
 
 		unsigned int ebo;
 		glGenBuffers(1, &ebo);
@@ -356,6 +430,7 @@ AnimatedModel::ModelData& AnimatedModel::ConstructModelData(std::string name, st
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferView.byteLength, &indexBuffer.data.at(0) + indexBufferView.byteOffset, GL_STATIC_DRAW);
 		newModelData.nIndices = indexAccessor.count;
+		newModelData.nVertices = data.accessors[primitiveData.attributes.at("POSITION")].count;
 
 		//Set up vertex attrib pointers
 		for (auto& attrib : primitiveData.attributes)
@@ -406,8 +481,27 @@ AnimatedModel::ModelData& AnimatedModel::ConstructModelData(std::string name, st
 				throw std::exception(errorMessage.c_str());
 			}
 		}
+
+		//Set up per instance data, the attributes are pointed at the stream buffer whenever the render queue is uploaded
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			glEnableVertexAttribArray(instanceAttribLocation + i);
+			glVertexAttribDivisor(instanceAttribLocation + i, 1);
+		}
+		glEnableVertexAttribArray(paletteOffsetAttribLocation);
+		glVertexAttribDivisor(paletteOffsetAttribLocation, 1);
+		glEnableVertexAttribArray(faceMaskAttribLocation);
+		glVertexAttribDivisor(faceMaskAttribLocation, 1);
+		glEnableVertexAttribArray(vertexOffsetAttribLocation);
+		glVertexAttribDivisor(vertexOffsetAttribLocation, 1);
 		GL_ERROR_CHECK();
 
+		//All models share one skinned vertex buffer
+		if (!skinningShader)
+		{
+			InitSkinning();
+		}
+
 		//-------------------------Step 5: Load animation and joint data-------------------------------------------------
 
 		//Load joints
@@ -569,62 +663,51 @@ AnimatedModel::ModelData& AnimatedModel::ConstructModelData(std::string name, st
 			newModelData.animations[tinyAnimation.name] = animation;
 		}
 
+		//Calculate bounds per animation, so instances can be culled without looking at their current pose
+		std::vector<EliMath::AABB> jointBounds = CalculateJointBounds(data, primitiveData, newModelData.joints.size());
+		const tinygltf::Accessor& positionAccessor = data.accessors[primitiveData.attributes.at("POSITION")];
+		EliMath::AABB modelBounds;
+		if (positionAccessor.minValues.size() == 3 && positionAccessor.maxValues.size() == 3)
+		{
+			modelBounds.Grow(glm::vec3(positionAccessor.minValues[0], positionAccessor.minValues[1], positionAccessor.minValues[2]));
+			modelBounds.Grow(glm::vec3(positionAccessor.maxValues[0], positionAccessor.maxValues[1], positionAccessor.maxValues[2]));
+		}
+		for (std::pair<const std::string, Animation>& element : newModelData.animations)
+		{
+			Animation& animation = element.second;
+			animation.bounds = CalculateAnimationBounds(newModelData, animation, jointBounds);
+			if (animation.bounds.IsEmpty())
+			{
+				//Skinning data that couldn't be read, fall back to the bind pose
+				animation.bounds = modelBounds;
+			}
+			animation.boundingSphere = EliMath::SphereFromAABB(animation.bounds);
+			modelBounds.Grow(animation.bounds);
+		}
+		newModelData.boundingSphere = EliMath::SphereFromAABB(modelBounds);
+
 		//-------------------------Step 6: Set up the texture-------------------------------------------------
 		//Gain access to the gltf data
 		const tinygltf::Material& material = data.materials[primitiveData.material];
 		tinygltf::Texture& textureData = data.textures[material.pbrMetallicRoughness.baseColorTexture.index];
 		tinygltf::Image& image = data.images[textureData.source];
 
-		//Figure out format
-		GLenum format;
-		switch (image.component)
-		{
-		case 1:
-			format = GL_RED;
-			break;
-		case 2:
-			format = GL_RG;
-			break;
-		case 3:
-			format = GL_RGB;
-			break;
-		case 4:
-			format = GL_RGBA;
-			break;
-		default:
-			std::string errorMessage;
-			errorMessage.append("The texture for ");
-			errorMessage.append(name);
-			errorMessage.append(" could not be loaded, because it had an unsupported format: ");
-			errorMessage.append(std::to_string(image.component));
-			errorMessage.append(" components");
-			throw std::exception(errorMessage.c_str());
-		}
-
-		//Figure out the type
-		GLenum type;
-		switch (image.bits)
-		{
-		case 8:
-			type = GL_UNSIGNED_BYTE;
-			break;
-		case 16:
-			type = GL_UNSIGNED_SHORT;
-			break;
-		}
+		//Resized to a power of two so the mip chain goes all the way down, then mipmapped and compressed
+		int size = TextureArrayPool::GetLayerSize(image);
+		TextureBuilder::Texture texture = TextureBuilder::Build(TextureArrayPool::ResizeImage(image, size, name), size, size, name);
 
 		//Generate texture
 		glGenTextures(1, &newModelData.texture);
-		glBindTexture(GL_TEXTURE_2D, newModelData.texture);
+		GlState::BindTexture(GL_TEXTURE_2D, newModelData.texture);
 
 		//Set texture settings
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		//Load data into texture
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, format, type, &image.image.at(0));
+		TextureBuilder::Upload2D(texture);
 
 		GL_ERROR_CHECK();
 	}
@@ -632,24 +715,135 @@ AnimatedModel::ModelData& AnimatedModel::ConstructModelData(std::string name, st
 	return existingModels.at(name);
 }
 
-std::vector<glm::mat4> AnimatedModel::GetJointTransforms() const
+void AnimatedModel::InitSkinning()
 {
-	std::vector<glm::mat4> result;
-	for (const Joint& j : modelData.joints)
+	skinningShader = std::make_unique<Shader>("Skinning.vert", std::vector<std::string>{ "skinnedPosition", "skinnedNormal" });
+	skinningShader->Use();
+	skinningShader->SetUniformInt("jointPalette", paletteTextureUnit);
+
+	//Start out with room for a decent crowd, the buffer grows when needed
+	skinnedVertexCapacity = 64 * 1024;
+
+	glGenBuffers(1, &skinnedVertexBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, skinnedVertexBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, skinnedVertexCapacity * skinnedVertexSize, nullptr, GL_STREAM_COPY);
+
+	//Every vertex is read as 2 RGBA texels
+	glGenTextures(1, &skinnedVertexTexture);
+	GlState::BindTexture(GL_TEXTURE_BUFFER, skinnedVertexTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, skinnedVertexBuffer);
+
+	//The skinned vertices stay bound to their own unit
+	GlState::ActiveTexture(skinnedVertexTextureUnit);
+	GlState::BindTexture(GL_TEXTURE_BUFFER, skinnedVertexTexture);
+	GlState::ActiveTexture(0);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	GL_ERROR_CHECK();
+}
+
+void AnimatedModel::ReserveSkinnedVertices(size_t nVertices)
+{
+	if (nVertices <= skinnedVertexCapacity)
+	{
+		//Orphan last frame's vertices so the driver doesn't have to wait for them
+		if (nSkinnedVertices == 0)
+		{
+			glBindBuffer(GL_TEXTURE_BUFFER, skinnedVertexBuffer);
+			glBufferData(GL_TEXTURE_BUFFER, skinnedVertexCapacity * skinnedVertexSize, nullptr, GL_STREAM_COPY);
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		}
+		return;
+	}
+
+	while (skinnedVertexCapacity < nVertices)
+	{
+		skinnedVertexCapacity *= 2;
+	}
+
+	//Vertices that were skinned earlier this frame are still needed, so they're copied into the new buffer
+	unsigned int newBuffer;
+	glGenBuffers(1, &newBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, skinnedVertexCapacity * skinnedVertexSize, nullptr, GL_STREAM_COPY);
+	if (nSkinnedVertices > 0)
 	{
-		result.push_back(j.transform);
+		glBindBuffer(GL_COPY_READ_BUFFER, skinnedVertexBuffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, nSkinnedVertices * skinnedVertexSize);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
 	}
-	return result;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(1, &skinnedVertexBuffer);
+	skinnedVertexBuffer = newBuffer;
+
+	GlState::BindTexture(GL_TEXTURE_BUFFER, skinnedVertexTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, skinnedVertexBuffer);
+	GlState::BindTexture(GL_TEXTURE_BUFFER, 0);
+	GL_ERROR_CHECK();
 }
 
-void AnimatedModel::ApplyPoseToJointsRecursively(const std::vector<glm::mat4>& pose, Joint& headJoint, const glm::mat4& parentTransform)
+int AnimatedModel::UploadPalettes(StreamBuffer& streamBuffer)
 {
-	glm::mat4 currentLocalTransform = pose[headJoint.id];
-	glm::mat4 currentTransform = parentTransform * currentLocalTransform;
-	for (Joint* child : headJoint.children)
+	if (nUploadedPaletteMatrices == framePalettes.size())
 	{
-		ApplyPoseToJointsRecursively(pose, *child, currentTransform);
+		return 0;
 	}
-	currentTransform *= headJoint.inverseInitialTransform;
-	headJoint.transform = currentTransform;
+
+	//Only upload the poses that aren't on the GPU yet, they end up in a different part of the stream buffer than the earlier ones.
+	//The palette is read through the texture buffer that covers the whole stream buffer, so the offsets of these poses are shifted
+	StreamBuffer::Range range = streamBuffer.Upload(&framePalettes[nUploadedPaletteMatrices][0][0],
+		(framePalettes.size() - nUploadedPaletteMatrices) * sizeof(glm::mat4),
+		sizeof(glm::mat4));
+	int shift = (int)(range.offset / sizeof(glm::mat4)) - (int)nUploadedPaletteMatrices;
+	nUploadedPaletteMatrices = framePalettes.size();
+
+	GlState::ActiveTexture(paletteTextureUnit);
+	GlState::BindTexture(GL_TEXTURE_BUFFER, streamBuffer.GetTexture());
+	GlState::ActiveTexture(0);
+	GL_ERROR_CHECK();
+	return shift;
+}
+
+float AnimatedModel::GetNearestInstanceDistance(const ModelData& model, glm::vec3 viewPos)
+{
+	float nearest = std::numeric_limits<float>::max();
+	for (const InstanceData& instance : model.renderQueue)
+	{
+		nearest = std::min(nearest, glm::distance(viewPos, glm::vec3(instance.modelTransform[3])));
+	}
+	return nearest;
 }
+
+void AnimatedModel::UploadInstances(const ModelData& model, const std::vector<InstanceData>& instances, StreamBuffer& streamBuffer)
+{
+	StreamBuffer::Range range = streamBuffer.Upload(instances.data(), instances.size() * sizeof(InstanceData));
+
+	//The vao keeps pointing at this range until the next upload, which only happens after the pass has been executed
+	GlState::BindVertexArray(model.vao);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.GetBuffer());
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(instanceAttribLocation + i,
+			4,
+			GL_FLOAT,
+			GL_FALSE,
+			sizeof(InstanceData),
+			(char*)0 + range.offset + i * sizeof(glm::vec4));
+	}
+	glVertexAttribIPointer(paletteOffsetAttribLocation,
+		1,
+		GL_INT,
+		sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, paletteOffset));
+	glVertexAttribIPointer(faceMaskAttribLocation,
+		1,
+		GL_INT,
+		sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, faceMask));
+	glVertexAttribIPointer(vertexOffsetAttribLocation,
+		1,
+		GL_INT,
+		sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, vertexOffset));
+	GlState::BindVertexArray(0);
+}
\ No newline at end of file
@@ -5,13 +5,16 @@
 #include <glm/glm.hpp>
 
 #include "Shader.h"
+#include "RenderQueue.h"
+#include "EliMath.h"
+#include "Light.h"
+#include "StreamBuffer.h"
 #include "Joint.h"
 #include "KeyFrame.h"
 
 #include <memory>
 
 class Camera;
-class Light;
 
 /*WARNING: This class will leak memory, but due to the predictable nature of the gameplay,
 it does not make a difference whether I implement the rule of 5 or not.*/
@@ -23,15 +26,27 @@ private:
 	{
 		float duration = 0.0f;
 		std::vector<KeyFrame> frames;
+
+		//Conservative bounds of every pose in this animation, in model space
+		EliMath::AABB bounds;
+		EliMath::BoundingSphere boundingSphere;
+	};
+	struct InstanceData
+	{
+		glm::mat4 modelTransform;
+		int paletteOffset;	//Index of this instance's first joint transform in the frame's joint palette
+		int faceMask = Light::allFaces;	//Shadow cube map faces this instance is drawn to, only used by the shadow pass
+		int vertexOffset = 0;	//Index of this instance's first vertex in the frame's skinned vertex buffer
 	};
 	struct ModelData
 	{
 		//Geometry
 		unsigned int vao = 0;
 		size_t nIndices = 0;
+		size_t nVertices = 0;
 
-		//Shader
-		std::unique_ptr<Shader> shader;
+		//Shader, shared with all other models that use the same shader files
+		const Shader* shader = nullptr;
 
 		//Texture
 		unsigned int texture = 0;	//Only supports models with single textures for now
@@ -43,8 +58,16 @@ private:
 
 		std::unordered_map<std::string, Animation> animations;	//Map of all the animations in this model
 
-		//Queue of transforms and poses for all instances of this model
-		std::vector<std::tuple<glm::mat4, glm::mat4,  std::vector<glm::mat4>>> renderQueue;
+		//Union of the bind pose and all animation bounds, used when the current animation isn't known
+		EliMath::BoundingSphere boundingSphere;
+
+		//Queue of transforms and palette offsets for all instances of this model, poses are stored in framePalettes
+		std::vector<InstanceData> renderQueue;
+		//Instances outside of the view frustum, these can still cast shadows into it
+		std::vector<InstanceData> culledQueue;
+		//Instances at the front of both queues that have already been skinned this frame
+		size_t nSkinnedVisible = 0;
+		size_t nSkinnedCulled = 0;
 	};
 public:
 	AnimatedModel(std::string name,
@@ -59,8 +82,10 @@ public:
 
 	void Update(float dt);
 	void AddToRenderQueue(Camera& camera);
-	static void DrawAllInstances(const Light& light);
-	static void DrawShadows(const Light& light);
+	static void SubmitInstances(RenderQueue& renderQueue, StreamBuffer& streamBuffer);
+	static void SubmitShadowCasters(RenderQueue& renderQueue, Light& light, StreamBuffer& streamBuffer);
+	//Skin every instance queued since the last call, both submit functions do this themselves
+	static void SkinInstances(StreamBuffer& streamBuffer);
 
 	void SetAnimation(std::string name);
 	void SetCurrentAnimationTime(float time);
@@ -75,8 +100,19 @@ public:
 	int GetJointIndex(std::string jointName) const;
 	const std::vector<glm::mat4>& GetPose() const;
 	const glm::mat4& GetTransform() const;
+public:
+	static constexpr int paletteTextureUnit = 3;	//Units 0 to 2 are used by the model texture and the shadow maps
+	static constexpr int skinnedVertexTextureUnit = 4;
 private:
 	static ModelData& ConstructModelData(std::string name, std::string vertexShader, std::string fragShader);
+	static void InitSkinning();
+	static int UploadPalettes(StreamBuffer& streamBuffer);
+	static void ReserveSkinnedVertices(size_t nVertices);
+	static void UploadInstances(const ModelData& model, const std::vector<InstanceData>& instances, StreamBuffer& streamBuffer);
+	static std::vector<EliMath::AABB> CalculateJointBounds(tinygltf::Model& data, const tinygltf::Primitive& primitiveData, size_t nJoints);
+	static EliMath::AABB CalculateAnimationBounds(const ModelData& model, const Animation& animation, const std::vector<EliMath::AABB>& jointBounds);
+	static void CalculateSkinningMatricesRecursively(const std::vector<glm::mat4>& localPose, const Joint& headJoint, const glm::mat4& parentTransform, std::vector<glm::mat4>& result);
+	static float GetNearestInstanceDistance(const ModelData& model, glm::vec3 viewPos);
 
 	std::vector<glm::mat4> GetJointTransforms() const;	//Retrieve transform per joint
 	void ApplyPoseToJointsRecursively(const std::vector<glm::mat4>& pose, Joint& headJoint, const glm::mat4& parentTransform);
@@ -95,4 +131,27 @@ private:
 	//Data for instancing
 	static std::unordered_map<std::string, ModelData> existingModels;
 	ModelData& modelData;
+	static std::vector<InstanceData> shadowCasters;	//Scratch space, reused every frame
+	static const Shader* depthPrepassShader;	//Reads the skinned vertices, just like the lit shaders
+	static std::vector<InstanceData> skinningInstances;	//Scratch space, reused every frame
+
+	//The poses of all instances queued this frame are packed into one joint palette,
+	//which is streamed to the GPU right before skinning
+	static std::vector<glm::mat4> framePalettes;
+	static size_t nUploadedPaletteMatrices;	//framePalettes up to this index are already on the GPU
+
+	//Every queued instance is skinned once per frame with transform feedback, the shadow pass and the colour pass
+	//both read the skinned vertices from this buffer instead of skinning them again
+	static std::unique_ptr<Shader> skinningShader;
+	static size_t nSkinnedVertices;	//Vertices written to skinnedVertexBuffer this frame
+	static size_t skinnedVertexCapacity;	//Size of skinnedVertexBuffer in vertices
+	static unsigned int skinnedVertexBuffer;
+	static unsigned int skinnedVertexTexture;
+
+	//The model matrix takes up 4 attribute locations (one per column), followed by the palette offset
+	static constexpr unsigned int instanceAttribLocation = 5;
+	static constexpr unsigned int paletteOffsetAttribLocation = instanceAttribLocation + 4;
+	static constexpr unsigned int faceMaskAttribLocation = paletteOffsetAttribLocation + 1;
+	static constexpr unsigned int vertexOffsetAttribLocation = faceMaskAttribLocation + 1;
+	static constexpr size_t skinnedVertexSize = 2 * sizeof(glm::vec4);	//World space position and normal
 };
\ No newline at end of file
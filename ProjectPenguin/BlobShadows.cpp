@@ -0,0 +1,128 @@
+#include "BlobShadows.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+#include "Shader.h"
+#include "GlGetError.h"
+#include "GlState.h"
+
+BlobShadows::BlobShadows(glm::vec2 areaCenter, glm::vec2 areaHalfSize)
+	:
+	areaCenter(areaCenter),
+	areaHalfSize(areaHalfSize)
+{
+}
+
+void BlobShadows::Add(glm::vec3 position)
+{
+	float radius = (maxHeight - position.y) / maxHeight * groundRadius;
+	if (radius > 0.0f)
+	{
+		blobs.push_back({ glm::vec2(position.x, position.z), radius });
+	}
+}
+
+void BlobShadows::Render()
+{
+	if (fbo == 0)
+	{
+		InitGraphics();
+	}
+
+	int prevViewport[4];
+	GlState::GetViewport(prevViewport);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, fbo);
+	GlState::Viewport(0, 0, resolutionX, resolutionY);
+	//Doesn't touch the clear colour of the other framebuffers
+	const float black[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	glClearBufferfv(GL_COLOR, 0, black);
+
+	if (!blobs.empty())
+	{
+		//Orphaned every frame, there are only a few blobs
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+		glBufferData(GL_ARRAY_BUFFER, blobs.size() * sizeof(Blob), blobs.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		shader->Use();
+		GlState::BindVertexArray(vao);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)blobs.size());
+		GlState::BindVertexArray(0);
+		blobs.clear();
+	}
+
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlState::Viewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+	GlState::ActiveTexture(textureUnit);
+	GlState::BindTexture(GL_TEXTURE_2D, texture);
+	GlState::ActiveTexture(0);
+	GL_ERROR_CHECK();
+}
+
+glm::vec4 BlobShadows::GetArea() const
+{
+	return glm::vec4(areaCenter, areaHalfSize * 2.0f);
+}
+
+size_t BlobShadows::GetNumBlobs() const
+{
+	return blobs.size();
+}
+
+float BlobShadows::GetRadius(size_t index) const
+{
+	return blobs[index].radius;
+}
+
+void BlobShadows::InitGraphics()
+{
+	//Only one channel is needed, filtering softens the edges a bit
+	glGenTextures(1, &texture);
+	GlState::BindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, resolutionX, resolutionY, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	//The border colour defaults to black, so there are no shadows outside of the area
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	GlState::BindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &fbo);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		throw std::exception("Blob shadow framebuffer is not complete");
+	}
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	//Corners of a quad around each blob, drawn as a strip
+	float corners[] = {
+		-1.0f, -1.0f,
+		1.0f, -1.0f,
+		-1.0f, 1.0f,
+		1.0f, 1.0f
+	};
+	glGenVertexArrays(1, &vao);
+	GlState::BindVertexArray(vao);
+	glGenBuffers(1, &quadVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glGenBuffers(1, &instanceVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+	glVertexAttribPointer(blobAttribLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Blob), (void*)0);
+	glEnableVertexAttribArray(blobAttribLocation);
+	glVertexAttribDivisor(blobAttribLocation, 1);
+	GlState::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	shader = &Shader::GetShared("BlobShadow.vert", "BlobShadow.frag");
+	shader->Use();
+	shader->SetUniformVec4("area", glm::vec4(areaCenter, areaHalfSize));
+	GL_ERROR_CHECK();
+}
\ No newline at end of file
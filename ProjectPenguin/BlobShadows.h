@@ -0,0 +1,55 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <vector>
+
+class Shader;
+
+//Round shadows of small flying objects, drawn top-down into a texture once per frame so shaders of the ground
+//only need a single lookup. Objects higher up cast smaller shadows, above maxHeight they don't cast any.
+//The area is given in world space on the xz plane, the texture is black outside of it.
+class BlobShadows
+{
+private:
+	struct Blob
+	{
+		glm::vec2 center;	//xz
+		float radius;
+	};
+public:
+	BlobShadows(glm::vec2 areaCenter, glm::vec2 areaHalfSize);
+	BlobShadows(const BlobShadows&) = delete;
+	BlobShadows operator=(const BlobShadows&) = delete;
+
+	void Add(glm::vec3 position);
+	//Draws every blob added since the last call into the texture, also binds the texture to its texture unit
+	void Render();
+
+	//Pass to a shader to map world xz to texture coordinates: (xz - area.xy) / area.zw + 0.5
+	glm::vec4 GetArea() const;
+	size_t GetNumBlobs() const;
+	float GetRadius(size_t index) const;
+public:
+	static constexpr int textureUnit = 6;
+private:
+	void InitGraphics();
+private:
+	static constexpr int resolutionX = 1024;
+	static constexpr int resolutionY = 512;
+	static constexpr float maxHeight = 10.0f;
+	static constexpr float groundRadius = 0.3f;	//Radius of the shadow of an object on the ground
+	static constexpr unsigned int blobAttribLocation = 1;	//The quad uses location 0
+
+	const glm::vec2 areaCenter;
+	const glm::vec2 areaHalfSize;
+	std::vector<Blob> blobs;	//Cleared after every render, the capacity is kept
+
+	//Created on the first render, so blobs can be added without a context
+	const Shader* shader = nullptr;
+	unsigned int fbo = 0;
+	unsigned int texture = 0;
+	unsigned int vao = 0;
+	unsigned int quadVbo = 0;
+	unsigned int instanceVbo = 0;
+};
\ No newline at end of file
@@ -34,6 +34,7 @@ void Camera::SetAspectRatio(float ratio)
 void Camera::CalculateVPMatrix()
 {
 	viewProjection = projection * view;
+	frustum = EliMath::ExtractFrustum(viewProjection);
 }
 
 glm::mat4 Camera::GetVPMatrix() const
@@ -41,6 +42,11 @@ glm::mat4 Camera::GetVPMatrix() const
 	return viewProjection;
 }
 
+bool Camera::IsInView(const EliMath::BoundingSphere& sphere) const
+{
+	return EliMath::IsInFrustum(frustum, sphere);
+}
+
 float Camera::GetFOVRadians() const
 {
 	return fov;
@@ -2,6 +2,8 @@
 
 #include "glm/glm.hpp"
 
+#include "EliMath.h"
+
 class Camera
 {
 public:
@@ -16,11 +18,13 @@ public:
 	void CalculateVPMatrix();
 
 	glm::mat4 GetVPMatrix() const;
+	bool IsInView(const EliMath::BoundingSphere& sphere) const;
 	float GetFOVRadians() const;
 private:
 	glm::mat4 view;
 	glm::mat4 projection;
 	glm::mat4 viewProjection;
+	EliMath::Frustum frustum;	//Updated together with the view projection matrix
 
 	static constexpr float fov = glm::radians(45.0f);
 	static constexpr float nearPlane = 0.1f;
@@ -0,0 +1,47 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+
+DynamicResolution::DynamicResolution(float targetFrameTime, float minScale, float maxScale)
+	:
+	targetFrameTime(targetFrameTime),
+	minScale(minScale),
+	maxScale(maxScale),
+	scale(maxScale),
+	averageFrameTime(targetFrameTime)
+{
+}
+
+float DynamicResolution::Update(float frameTime)
+{
+	frameTime = std::min(frameTime, targetFrameTime * maxFrameTimeFactor);
+	averageFrameTime += (frameTime - averageFrameTime) * smoothing;
+	timeSinceChange += frameTime;
+
+	float newScale = scale;
+	if (averageFrameTime > targetFrameTime * lowerThreshold && timeSinceChange >= lowerDelay)
+	{
+		newScale = std::max(minScale, scale - step);
+	}
+	else if (averageFrameTime < targetFrameTime * raiseThreshold && timeSinceChange >= raiseDelay)
+	{
+		newScale = std::min(maxScale, scale + step);
+	}
+
+	if (newScale != scale)
+	{
+		scale = newScale;
+		timeSinceChange = 0.0f;
+	}
+	return scale;
+}
+
+float DynamicResolution::GetScale() const
+{
+	return scale;
+}
+
+float DynamicResolution::GetAverageFrameTime() const
+{
+	return averageFrameTime;
+}
\ No newline at end of file
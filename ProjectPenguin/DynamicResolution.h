@@ -0,0 +1,30 @@
+#pragma once
+
+//Picks the resolution scale of the 3D scene from the frame time.
+//The scale drops as soon as frames are consistently slower than the target, and creeps back up while they're on time.
+//With vsync frames never finish early, so raising the scale is a probe: if it turns out too expensive, it drops again.
+class DynamicResolution
+{
+public:
+	DynamicResolution(float targetFrameTime, float minScale, float maxScale = 1.0f);
+
+	float Update(float frameTime);	//Returns the scale to render the next frame at
+	float GetScale() const;
+	float GetAverageFrameTime() const;
+private:
+	static constexpr float step = 0.05f;	//Scale change per adjustment
+	static constexpr float smoothing = 0.1f;	//Weight of the latest frame in the average frame time
+	static constexpr float maxFrameTimeFactor = 4.0f;	//Longer frames (loading, window dragging) are clamped to this many target frame times
+	static constexpr float lowerThreshold = 1.1f;	//Lower the scale when the average is this many target frame times
+	static constexpr float raiseThreshold = 1.02f;	//Raise the scale when the average is below this many target frame times
+	static constexpr float lowerDelay = 0.5f;	//Seconds after a change before the scale can drop, gives the average time to settle
+	static constexpr float raiseDelay = 2.0f;	//Seconds after a change before the scale can rise
+
+	const float targetFrameTime;
+	const float minScale;
+	const float maxScale;
+
+	float scale;
+	float averageFrameTime;
+	float timeSinceChange = 0.0f;
+};
\ No newline at end of file
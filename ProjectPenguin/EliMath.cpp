@@ -36,3 +36,108 @@ glm::vec3 EliMath::IntersectFloor(glm::vec3 origin, glm::vec3 direction)
 
 	return glm::vec3(x, y, z);
 }
+
+
+bool EliMath::AABB::IsEmpty() const
+{
+	return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+void EliMath::AABB::Grow(glm::vec3 point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void EliMath::AABB::Grow(const AABB& other)
+{
+	if (!other.IsEmpty())
+	{
+		Grow(other.min);
+		Grow(other.max);
+	}
+}
+
+EliMath::AABB EliMath::TransformAABB(const AABB& box, const glm::mat4& transform)
+{
+	AABB result;
+	if (box.IsEmpty())
+	{
+		return result;
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner((i & 1) ? box.max.x : box.min.x,
+			(i & 2) ? box.max.y : box.min.y,
+			(i & 4) ? box.max.z : box.min.z);
+		result.Grow(glm::vec3(transform * glm::vec4(corner, 1.0f)));
+	}
+	return result;
+}
+
+EliMath::BoundingSphere EliMath::SphereFromAABB(const AABB& box)
+{
+	BoundingSphere result;
+	if (!box.IsEmpty())
+	{
+		result.center = (box.min + box.max) * 0.5f;
+		result.radius = glm::length(box.max - box.min) * 0.5f;
+	}
+	return result;
+}
+
+EliMath::BoundingSphere EliMath::TransformSphere(const BoundingSphere& sphere, const glm::mat4& transform)
+{
+	float scale = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+	BoundingSphere result;
+	result.center = glm::vec3(transform * glm::vec4(sphere.center, 1.0f));
+	result.radius = sphere.radius * scale;
+	return result;
+}
+
+EliMath::Frustum EliMath::ExtractFrustum(const glm::mat4& viewProjection)
+{
+	//Gribb/Hartmann plane extraction, glm matrices are column major so rows have to be gathered by hand
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	Frustum result;
+	result.planes[0] = rows[3] + rows[0];	//Left
+	result.planes[1] = rows[3] - rows[0];	//Right
+	result.planes[2] = rows[3] + rows[1];	//Bottom
+	result.planes[3] = rows[3] - rows[1];	//Top
+	result.planes[4] = rows[3] + rows[2];	//Near
+	result.planes[5] = rows[3] - rows[2];	//Far
+	for (glm::vec4& plane : result.planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return result;
+}
+
+bool EliMath::IsInFrustum(const Frustum& frustum, const BoundingSphere& sphere)
+{
+	for (const glm::vec4& plane : frustum.planes)
+	{
+		if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uint64_t EliMath::HashBytes(const void* data, size_t size, uint64_t seed)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t result = seed;
+	for (size_t i = 0; i < size; i++)
+	{
+		result ^= bytes[i];
+		result *= 1099511628211ull;
+	}
+	return result;
+}
\ No newline at end of file
@@ -2,9 +2,48 @@
 
 #include "glm/glm.hpp"
 
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
 namespace EliMath
 {
+	//Axis aligned bounding box, a box that hasn't grown yet is empty (min > max)
+	struct AABB
+	{
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+		bool IsEmpty() const;
+		void Grow(glm::vec3 point);
+		void Grow(const AABB& other);
+	};
+
+	struct BoundingSphere
+	{
+		glm::vec3 center = glm::vec3(0.0f);
+		float radius = std::numeric_limits<float>::infinity();	//Spheres without proper bounds are never culled
+	};
+
+	//Six planes (xyz = normal pointing inwards, w = distance), the default frustum contains everything
+	struct Frustum
+	{
+		glm::vec4 planes[6] = {};
+	};
+
 	//Calculate where a ray hits the floor (y = 0)
 	//direction does not need to be normalized
 	glm::vec3 IntersectFloor(glm::vec3 origin, glm::vec3 direction);
+
+	//Box around the transformed corners of box
+	AABB TransformAABB(const AABB& box, const glm::mat4& transform);
+	BoundingSphere SphereFromAABB(const AABB& box);
+	//Scaling is taken into account by using the largest scale of the transform
+	BoundingSphere TransformSphere(const BoundingSphere& sphere, const glm::mat4& transform);
+
+	Frustum ExtractFrustum(const glm::mat4& viewProjection);
+	bool IsInFrustum(const Frustum& frustum, const BoundingSphere& sphere);
+
+	//64 bit FNV-1a hash, pass the result of a previous call as seed to hash several blocks of data together
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Window.h"
 #include "GlGetError.h"
+#include "GlState.h"
 
 #include <iostream>
 #include <sstream>
@@ -23,6 +24,8 @@ Game::Game(Window& window)
 	fishingPenguinRotationRange(1.57079f, 4.71238f),
 	rng(std::random_device()()),
 	light(glm::vec3(0.0f, 10.0f, 0.0f), saveFile.GetShadowRes()),
+	frameConstants(UniformBlock::FrameConstants, sizeof(FrameConstants)),
+	streamBuffer(streamBufferFrameSize),
 	screenQuad(window, saveFile),
 	penguinDresser(rng),
 	randomStackSpawnInterval(10.0f, 30.0f),	//REPLACE these values
@@ -40,6 +43,7 @@ Game::Game(Window& window)
 {
 	window.SetMainCamera(&camera);
 	window.SetScreenQuad(&screenQuad);
+	light.SetShadowUpdateInterval(saveFile.GetShadowUpdateInterval());
 	camera.SetPos(glm::vec3(0.0f, 10.0f, 1.0f));
 	
 	//Seed randomness for penguin spawns, REPLACE if there's a better way
@@ -84,6 +88,7 @@ Game::Game(Window& window)
 	highScore = saveFile.GetHighScore();
 	window.SetSelectedMonitor(saveFile.GetSelectedMonitor());
 	window.SetFullscreen(saveFile.GetFullScreenOn());
+	renderQueue.SetDepthPrepass(saveFile.GetDepthPrepassOn());
 
 	//Preload some models to save time later
 	AnimatedModel::Preload("Goopie.gltf");
@@ -96,6 +101,7 @@ Game::Game(Window& window)
 void Game::Update()
 {
 	const float frameTime = ft.Mark();
+	screenQuad.UpdateResolutionScale(frameTime);
 	switch (state)
 	{
 	case State::Tutorial:
@@ -131,10 +137,32 @@ void Game::Update()
 	{
 		window.SetFullscreen(!window.IsFullScreen());
 	}
+
+	//Dump GPU timings
+	const bool profilerDumpKeyState = input.IsPressed(GLFW_KEY_F12);
+	if (profilerDumpKeyState && !prevProfilerDumpKeyState)
+	{
+		gpuProfiler.Dump("GpuProfile.json");
+		std::cout << "GPU timings written to UserData/GpuProfile.json" << std::endl;
+	}
+	prevProfilerDumpKeyState = profilerDumpKeyState;
+
+	//Toggle the depth pre-pass, to compare the scene timings with and without it
+	const bool depthPrepassKeyState = input.IsPressed(GLFW_KEY_F11);
+	if (depthPrepassKeyState && !prevDepthPrepassKeyState)
+	{
+		renderQueue.SetDepthPrepass(!renderQueue.UsesDepthPrepass());
+		std::cout << "Depth pre-pass " << (renderQueue.UsesDepthPrepass() ? "on" : "off") << std::endl;
+	}
+	prevDepthPrepassKeyState = depthPrepassKeyState;
 }
 
 void Game::Draw()
 {
+	//Everything streamed to the GPU this frame is allocated between these calls
+	streamBuffer.BeginFrame();
+	gpuProfiler.BeginFrame();
+
 	switch (state)
 	{
 	case State::Tutorial:
@@ -166,6 +194,45 @@ void Game::Draw()
 		DrawGameOverMenu();
 		break;
 	}
+
+	gpuProfiler.EndFrame();
+	streamBuffer.EndFrame();
+
+#ifdef _DEBUG
+	//Uniforms should be set through handles, report when a frame falls back to names
+	const unsigned int nStringLookups = Shader::GetStringLookupCount();
+	if (nStringLookups != prevStringLookups)
+	{
+		std::cout << "Uniforms set by name this frame: " << nStringLookups << std::endl;
+		prevStringLookups = nStringLookups;
+	}
+
+	//State changes that GlState dropped because the value was already set
+	const unsigned int nSkippedGlCalls = GlState::GetSkippedCallCount();
+	if (nSkippedGlCalls != prevSkippedGlCalls)
+	{
+		std::cout << "Redundant GL state changes skipped this frame: " << nSkippedGlCalls << std::endl;
+		prevSkippedGlCalls = nSkippedGlCalls;
+	}
+
+	//Report draw calls and state changes whenever they change
+	const RenderQueue::Stats& renderStats = renderQueue.GetStats();
+	if (renderStats.nDraws != prevRenderStats.nDraws
+		|| renderStats.nProgramChanges != prevRenderStats.nProgramChanges
+		|| renderStats.nTextureChanges != prevRenderStats.nTextureChanges
+		|| renderStats.nVaoChanges != prevRenderStats.nVaoChanges
+		|| renderStats.nMultiDraws != prevRenderStats.nMultiDraws)
+	{
+		std::cout << "Draws: " << renderStats.nDraws
+			<< " (" << renderStats.nInstances << " instances, " << renderStats.nMultiDraws << " multi draws), program changes: " << renderStats.nProgramChanges
+			<< ", texture changes: " << renderStats.nTextureChanges
+			<< ", vao changes: " << renderStats.nVaoChanges << std::endl;
+		prevRenderStats = renderStats;
+	}
+#endif
+	Shader::ResetStringLookupCount();
+	GlState::ResetSkippedCallCount();
+	renderQueue.ResetStats();
 }
 
 bool Game::ReadyToQuit() const
@@ -218,26 +285,45 @@ void Game::SetUpBakedShadows()
 	iceRink.DrawStatic(camera);
 	choir.Draw(camera);
 
+	light.BeginShadowCasters();
+	streamBuffer.BeginFrame();
+	Model::SubmitShadowCasters(renderQueue, light, streamBuffer);
+	StaticBatch::SubmitShadowCasters(renderQueue, light, streamBuffer);
+	uint64_t signature = light.GetShadowCasterSignature();
+
+	//Reuse the shadows of a previous run if nothing static has changed since
+	if (light.LoadBakedShadows("BakedShadows.bin", signature))
+	{
+		renderQueue.Clear();
+		streamBuffer.EndFrame();
+		light.UseNonBakeTexture();
+		return;
+	}
+
 	light.UseBakeTexture();
 
-	glCullFace(GL_FRONT);
+	GlState::CullFace(GL_FRONT);
 
 	//Prepare shadow FBO
-	glViewport(0, 0, light.GetShadowResolutionX(), light.GetShadowResolutionY());
-	glBindFramebuffer(GL_FRAMEBUFFER, light.GetFBO());
+	GlState::Viewport(0, 0, light.GetShadowResolutionX(), light.GetShadowResolutionY());
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, light.GetFBO());
 	glClear(GL_DEPTH_BUFFER_BIT);
 	GL_ERROR_CHECK();
-	//Bind shader and draw shadows
-	light.UseNonAnimationShader();
-	Model::DrawShadows(light);
+	//Draw shadows
+	light.BindUniformBuffers();
+	light.SetActiveFaces(Light::allFaces);
+	renderQueue.Execute();
+	streamBuffer.EndFrame();
 	//Revert to default FBO
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, window.GetWidth(), window.GetHeight());
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlState::Viewport(0, 0, window.GetWidth(), window.GetHeight());
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	glCullFace(GL_BACK);
+	GlState::CullFace(GL_BACK);
 
 	light.UseNonBakeTexture();
+
+	light.SaveBakedShadows("BakedShadows.bin", signature);
 }
 
 void Game::StartPlaying()
@@ -699,22 +785,42 @@ void Game::EndPlaying()
 
 void Game::DrawShadows()
 {
-	glCullFace(GL_FRONT);
-	//Prepare shadow FBO
-	glViewport(0, 0, light.GetShadowResolutionX(), light.GetShadowResolutionY());
-	glBindFramebuffer(GL_FRAMEBUFFER, light.GetFBO());
-	glClear(GL_DEPTH_BUFFER_BIT);
-	GL_ERROR_CHECK();
-	//Bind shader and draw shadows
-	light.UseAnimationShader();
-	AnimatedModel::DrawShadows(light);
-	light.UseNonAnimationShader();
-	Model::DrawShadows(light);
-	//Revert to default FBO
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, (GLsizei)window.GetDimensions().x, (GLsizei)window.GetDimensions().y);
+	gpuProfiler.Begin("Shadows");
+
+	//The shadow map keeps its contents between frames, so skipped frames simply reuse the last one
+	if (light.ShouldUpdateShadows())
+	{
+		light.BeginShadowCasters();
+		AnimatedModel::SubmitShadowCasters(renderQueue, light, streamBuffer);
+		Model::SubmitShadowCasters(renderQueue, light, streamBuffer);
+
+		//Only redraw the faces of the cube map whose casters moved, appeared or disappeared
+		int dirtyFaces = light.UpdateDirtyFaces();
+		if (dirtyFaces != 0)
+		{
+			GlState::CullFace(GL_FRONT);
+			//Prepare shadow FBO
+			GlState::Viewport(0, 0, light.GetShadowResolutionX(), light.GetShadowResolutionY());
+			GlState::BindFramebuffer(GL_FRAMEBUFFER, light.GetFBO());
+			light.ResetDynamicFaces(dirtyFaces);
+			GL_ERROR_CHECK();
+			//Draw shadows
+			light.BindUniformBuffers();
+			light.SetActiveFaces(dirtyFaces);
+			renderQueue.Execute();
+			//Revert to default FBO
+			GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+			GlState::Viewport(0, 0, (GLsizei)window.GetDimensions().x, (GLsizei)window.GetDimensions().y);
+			GlState::CullFace(GL_BACK);
+		}
+		else
+		{
+			renderQueue.Clear();
+		}
+	}
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	glCullFace(GL_BACK);
+
+	gpuProfiler.End();
 }
 
 void Game::DrawPlaying()
@@ -733,7 +839,11 @@ void Game::DrawPlaying()
 	{
 		penguinStack->Draw(camera);
 	}
-	iceRink.DrawNonStatic(camera, GetCandyCanePositions());
+	for (const Collectible& c : collectibles)
+	{
+		iceRink.AddBlobShadow(c.GetPos());
+	}
+	iceRink.DrawNonStatic(camera);
 	for (HomingPenguin& hp : homingPenguins)
 	{
 		hp.Draw(camera);
@@ -751,62 +861,80 @@ void Game::DrawPlaying()
 	}
 
 	//Bind screenQuad
+	gpuProfiler.Begin("Scene");
 	screenQuad.StartFrame();
 	GL_ERROR_CHECK();
 
-	//Draw all entities
-	AnimatedModel::DrawAllInstances(light);
-	Model::DrawAllInstances(light);
-	glEnable(GL_BLEND);
-	smokeMachine.Draw(camera);
-	glDisable(GL_BLEND);
+	//Camera and light data are shared by all lit shaders
+	frameConstants.Update(FrameConstants{ camera.GetVPMatrix(), camera.GetPos() });
+	frameConstants.Bind();
+	light.BindUniformBuffers();
+	light.BindShadowMaps();
 
+	//Draw all entities
+	renderQueue.SetViewPos(camera.GetPos());
+	AnimatedModel::SubmitInstances(renderQueue, streamBuffer);
+	Model::SubmitInstances(renderQueue, streamBuffer);
+	StaticBatch::SubmitInstances(renderQueue, streamBuffer);
+	renderQueue.Execute();
+	gpuProfiler.End();
+
+	gpuProfiler.Begin("Smoke");
+	GlState::Enable(GL_BLEND);
+	smokeMachine.Draw(streamBuffer);
+	GlState::Disable(GL_BLEND);
+	gpuProfiler.End();
+
+	gpuProfiler.Begin("Resolve");
 	screenQuad.EndFrame();
+	gpuProfiler.End();
 
-	//Draw using effect
-	screenEffect.UseEffect();
+	//Draw using effect, this also upscales the scene to the window
+	gpuProfiler.Begin("PostEffect");
+	screenEffect.UseEffect(screenQuad.GetTexcoordScale(), screenQuad.GetMaxTexcoord());
 	auto screenTexture = screenQuad.GetTexture();
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, screenTexture);
+	GlState::ActiveTexture(0);
+	GlState::BindTexture(GL_TEXTURE_2D, screenTexture);
 
 	screenQuad.Draw();
+	gpuProfiler.End();
 }
 
 void Game::DrawGamePlayUI()
 {
+	gpuProfiler.Begin("UI");
 	gameplayUI.Draw();
 
-	glEnable(GL_BLEND);
-	plus5Dispenser.Draw(camera);
-	glDisable(GL_BLEND);
+	GlState::Enable(GL_BLEND);
+	plus5Dispenser.Draw(streamBuffer);
+	GlState::Disable(GL_BLEND);
+	gpuProfiler.End();
 }
 
 void Game::DrawTutorialUI()
 {
+	gpuProfiler.Begin("UI");
 	tutorialUI.Draw();
+	gpuProfiler.End();
 }
 
 void Game::DrawPauseMenu()
 {
+	gpuProfiler.Begin("UI");
 	pauseMenu.Draw();
+	gpuProfiler.End();
 }
 
 void Game::DrawMainMenu()
 {
+	gpuProfiler.Begin("UI");
 	mainMenu.Draw();
+	gpuProfiler.End();
 }
 
 void Game::DrawGameOverMenu()
 {
+	gpuProfiler.Begin("UI");
 	gameOverMenu.Draw();
-}
-
-std::vector<glm::vec3> Game::GetCandyCanePositions() const
-{
-	std::vector<glm::vec3> result;
-	for (const Collectible& candyCane : collectibles)
-	{
-		result.emplace_back(candyCane.GetPos());
-	}
-	return std::move(result);
+	gpuProfiler.End();
 }
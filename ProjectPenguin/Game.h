@@ -22,6 +22,7 @@
 #include "Choir.h"
 #include "SmokeMachine.h"
 #include "Plus5EffectDispenser.h"
+#include "GpuProfiler.h"
 
 class Window;
 
@@ -72,8 +73,6 @@ private:
 	void DrawPauseMenu();
 	void DrawMainMenu();
 	void DrawGameOverMenu();
-
-	std::vector<glm::vec3> GetCandyCanePositions() const;
 private:
 	Window& window;
 	Camera camera;
@@ -135,6 +134,13 @@ private:
 	bool quit = false;
 	bool tutorialFinished = false;
 
+	GpuProfiler gpuProfiler;	//Press F12 to dump the GPU time per pass
+	bool prevProfilerDumpKeyState = false;
+	bool prevDepthPrepassKeyState = false;	//Press F11 to toggle the depth pre-pass
+	unsigned int prevStringLookups = 0;	//Debug: uniforms set by name during the previous frame
+	unsigned int prevSkippedGlCalls = 0;	//Debug: redundant GL state changes skipped during the previous frame
+	RenderQueue::Stats prevRenderStats;	//Debug: draws and state changes during the previous frame
+
 	UICanvas mainMenu;
 	UICanvas pauseMenu;
 	UICanvas gameOverMenu;
@@ -149,6 +155,10 @@ private:
 	glm::vec3 currentCamLookat = glm::vec3(0.0f);
 
 	Light light;
+	UniformBuffer frameConstants;	//Camera data for the current frame
+	RenderQueue renderQueue;
+	static constexpr size_t streamBufferFrameSize = 4 * 1024 * 1024;
+	StreamBuffer streamBuffer;	//Per frame instance data and joint palettes
 
 	ScreenQuad screenQuad;
 	ScreenEffect screenEffect;
@@ -0,0 +1,77 @@
+#include "GeometryArena.h"
+
+#include <glad/glad.h>
+
+#include <sstream>
+
+#include "GlGetError.h"
+
+GeometryArena::Mesh GeometryArena::Add(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+	if (vertices.size() > blockVertices || indices.size() > blockIndices)
+	{
+		std::stringstream errorMessage;
+		errorMessage << "A mesh with " << vertices.size() << " vertices and " << indices.size() << " indices doesn't fit in a geometry arena block";
+		throw std::exception(errorMessage.str().c_str());
+	}
+
+	//Meshes don't span blocks, start a new one when the current one is full
+	if (blocks.empty()
+		|| blocks.back().nVertices + vertices.size() > blockVertices
+		|| blocks.back().nIndices + indices.size() > blockIndices)
+	{
+		AddBlock();
+	}
+	Block& block = blocks.back();
+
+	//The copy targets don't touch the element buffer binding of whatever vao is bound
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block.vbo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, block.nVertices * sizeof(Vertex), vertices.size() * sizeof(Vertex), vertices.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block.ebo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, block.nIndices * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	GL_ERROR_CHECK();
+
+	Mesh mesh;
+	mesh.block = blocks.size() - 1;
+	mesh.firstIndex = (unsigned int)block.nIndices;
+	mesh.nIndices = (unsigned int)indices.size();
+	mesh.baseVertex = (int)block.nVertices;
+
+	block.nVertices += vertices.size();
+	block.nIndices += indices.size();
+	return mesh;
+}
+
+void GeometryArena::SetUpVertexAttributes(size_t block) const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, blocks[block].vbo);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texcoord));
+	glEnableVertexAttribArray(2);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, blocks[block].ebo);
+	GL_ERROR_CHECK();
+}
+
+size_t GeometryArena::GetNumBlocks() const
+{
+	return blocks.size();
+}
+
+void GeometryArena::AddBlock()
+{
+	Block block;
+	glGenBuffers(1, &block.vbo);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block.vbo);
+	glBufferData(GL_COPY_WRITE_BUFFER, blockVertices * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+	glGenBuffers(1, &block.ebo);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block.ebo);
+	glBufferData(GL_COPY_WRITE_BUFFER, blockIndices * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	GL_ERROR_CHECK();
+
+	blocks.push_back(block);
+}
\ No newline at end of file
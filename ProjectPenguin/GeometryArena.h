@@ -0,0 +1,50 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <vector>
+#include <cstddef>
+
+//Shared vertex and index buffers that meshes are sub-allocated from, so meshes with the same vertex format
+//can be drawn without switching buffers, and with multi draw indirect, in one draw call.
+//Buffers are allocated in fixed size blocks and never move, vaos that point at a block stay valid.
+class GeometryArena
+{
+public:
+	//The vertex format of every mesh in the arena, attribute locations 0 to 2
+	struct Vertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 texcoord;
+	};
+	//Where a mesh ended up, indices are relative to baseVertex
+	struct Mesh
+	{
+		size_t block = 0;
+		unsigned int firstIndex = 0;
+		unsigned int nIndices = 0;
+		int baseVertex = 0;
+	};
+public:
+	Mesh Add(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+	//Point vertex attributes 0 to 2 and the element buffer of the bound vao at a block
+	void SetUpVertexAttributes(size_t block) const;
+	size_t GetNumBlocks() const;
+private:
+	struct Block
+	{
+		unsigned int vbo = 0;
+		unsigned int ebo = 0;
+		size_t nVertices = 0;
+		size_t nIndices = 0;
+	};
+private:
+	void AddBlock();
+private:
+	//Roughly 8MB of vertices and 4MB of indices per block, enough to fit every model in the game in one
+	static constexpr size_t blockVertices = 256 * 1024;
+	static constexpr size_t blockIndices = 1024 * 1024;
+
+	std::vector<Block> blocks;
+};
\ No newline at end of file
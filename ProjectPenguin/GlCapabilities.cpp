@@ -0,0 +1,67 @@
+#include "GlCapabilities.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+//Static members
+void* GlCapabilities::bufferStorage = nullptr;
+void* GlCapabilities::multiDrawElementsIndirect = nullptr;
+bool GlCapabilities::textureCompression = false;
+
+void GlCapabilities::Probe()
+{
+	int major = 0;
+	int minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	int version = major * 10 + minor;
+
+	if (version >= 44 || glfwExtensionSupported("GL_ARB_buffer_storage"))
+	{
+		bufferStorage = (void*)glfwGetProcAddress("glBufferStorage");
+	}
+	//Multi draw indirect is only useful together with base instance, which is what the draws use to find their instance data
+	if (version >= 43
+		|| (glfwExtensionSupported("GL_ARB_multi_draw_indirect") && glfwExtensionSupported("GL_ARB_base_instance")))
+	{
+		multiDrawElementsIndirect = (void*)glfwGetProcAddress("glMultiDrawElementsIndirect");
+	}
+	//Not part of any core version because of patents, but every desktop driver has it
+	textureCompression = glfwExtensionSupported("GL_EXT_texture_compression_s3tc") == GLFW_TRUE;
+
+	std::cout << "OpenGL " << major << "." << minor
+		<< ", buffer storage: " << (HasBufferStorage() ? "yes" : "no")
+		<< ", multi draw indirect: " << (HasMultiDrawIndirect() ? "yes" : "no")
+		<< ", texture compression: " << (HasTextureCompression() ? "yes" : "no") << std::endl;
+}
+
+bool GlCapabilities::HasBufferStorage()
+{
+	return bufferStorage != nullptr;
+}
+
+bool GlCapabilities::HasMultiDrawIndirect()
+{
+	return multiDrawElementsIndirect != nullptr;
+}
+
+bool GlCapabilities::HasTextureCompression()
+{
+	return textureCompression;
+}
+
+void GlCapabilities::BufferStorage(unsigned int target, ptrdiff_t size, const void* data, unsigned int flags)
+{
+	((PFNGLBUFFERSTORAGEPROC)bufferStorage)(target, size, data, flags);
+}
+
+void GlCapabilities::MultiDrawElementsIndirect(unsigned int mode, unsigned int type, size_t indirectOffset, int drawCount)
+{
+	//Commands are tightly packed, so the stride can stay 0
+	((PFNGLMULTIDRAWELEMENTSINDIRECTPROC)multiDrawElementsIndirect)(mode, type, (char*)0 + indirectOffset, drawCount, 0);
+}
\ No newline at end of file
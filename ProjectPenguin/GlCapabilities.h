@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+//Constants of the features below, the glad loader only covers OpenGL 3.3 core
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+//The window asks for a 3.3 core context, but drivers usually hand out the newest version they support.
+//Features beyond 3.3 are probed once after the context is created, their entry points are loaded through glfw.
+class GlCapabilities
+{
+public:
+	//Layout of a single draw in the indirect buffer, fixed by the spec
+	struct DrawElementsIndirectCommand
+	{
+		unsigned int count;
+		unsigned int instanceCount;
+		unsigned int firstIndex;
+		int baseVertex;
+		unsigned int baseInstance;
+	};
+public:
+	static void Probe();	//Needs a current context
+
+	static bool HasBufferStorage();	//GL 4.4 or GL_ARB_buffer_storage
+	static bool HasMultiDrawIndirect();	//GL 4.3 or GL_ARB_multi_draw_indirect, which also gives base instance
+	static bool HasTextureCompression();	//GL_EXT_texture_compression_s3tc, for BC1 and BC3 textures
+
+	//Only call these when the matching Has function returns true
+	static void BufferStorage(unsigned int target, ptrdiff_t size, const void* data, unsigned int flags);
+	static void MultiDrawElementsIndirect(unsigned int mode, unsigned int type, size_t indirectOffset, int drawCount);
+private:
+	static void* bufferStorage;
+	static void* multiDrawElementsIndirect;
+	static bool textureCompression;
+};
\ No newline at end of file
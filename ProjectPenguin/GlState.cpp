@@ -0,0 +1,259 @@
+#include "GlState.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+//Static members
+unsigned int GlState::program = GlState::unknown;
+unsigned int GlState::vao = GlState::unknown;
+unsigned int GlState::readFramebuffer = GlState::unknown;
+unsigned int GlState::drawFramebuffer = GlState::unknown;
+int GlState::viewport[4] = { 0, 0, 0, 0 };
+bool GlState::viewportKnown = false;
+unsigned int GlState::activeTexture = GlState::unknown;
+//Zero is what a new context starts with, Window invalidates everything once its context exists anyway
+unsigned int GlState::textures[GlState::nTextureUnits][(size_t)GlState::TextureTarget::Count] = {};
+unsigned int GlState::capabilities[(size_t)GlState::Capability::Count] = {};
+unsigned int GlState::cullFace = GlState::unknown;
+unsigned int GlState::depthFunc = GlState::unknown;
+unsigned int GlState::depthMask = GlState::unknown;
+unsigned int GlState::colorMask = GlState::unknown;
+unsigned int GlState::nSkippedCalls = 0;
+
+void GlState::UseProgram(unsigned int newProgram)
+{
+	if (Changes(program, newProgram))
+	{
+		glUseProgram(newProgram);
+	}
+}
+
+void GlState::BindVertexArray(unsigned int newVao)
+{
+	if (Changes(vao, newVao))
+	{
+		glBindVertexArray(newVao);
+	}
+}
+
+void GlState::BindFramebuffer(unsigned int target, unsigned int fbo)
+{
+	switch (target)
+	{
+	case GL_READ_FRAMEBUFFER:
+		if (Changes(readFramebuffer, fbo))
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+		}
+		break;
+	case GL_DRAW_FRAMEBUFFER:
+		if (Changes(drawFramebuffer, fbo))
+		{
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+		}
+		break;
+	default:
+		if (readFramebuffer == fbo && drawFramebuffer == fbo)
+		{
+			nSkippedCalls++;
+		}
+		else
+		{
+			readFramebuffer = fbo;
+			drawFramebuffer = fbo;
+			glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		}
+		break;
+	}
+}
+
+void GlState::Viewport(int x, int y, int width, int height)
+{
+	if (viewportKnown && viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height)
+	{
+		nSkippedCalls++;
+		return;
+	}
+	viewport[0] = x;
+	viewport[1] = y;
+	viewport[2] = width;
+	viewport[3] = height;
+	viewportKnown = true;
+	glViewport(x, y, width, height);
+}
+
+void GlState::GetViewport(int result[4])
+{
+	std::copy(viewport, viewport + 4, result);
+}
+
+void GlState::ActiveTexture(int unit)
+{
+	if (Changes(activeTexture, (unsigned int)unit))
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+}
+
+void GlState::BindTexture(unsigned int target, unsigned int texture)
+{
+	//Without a known unit there is nothing to compare with
+	int targetIndex = GetTargetIndex(target);
+	if (targetIndex < 0 || activeTexture >= (unsigned int)nTextureUnits)
+	{
+		if (targetIndex >= 0)
+		{
+			for (unsigned int(&unit)[(size_t)TextureTarget::Count] : textures)
+			{
+				unit[targetIndex] = unknown;
+			}
+		}
+		glBindTexture(target, texture);
+		return;
+	}
+	if (Changes(textures[activeTexture][targetIndex], texture))
+	{
+		glBindTexture(target, texture);
+	}
+}
+
+void GlState::DeleteTexture(unsigned int texture)
+{
+	for (unsigned int(&unit)[(size_t)TextureTarget::Count] : textures)
+	{
+		std::replace(std::begin(unit), std::end(unit), texture, 0u);
+	}
+	glDeleteTextures(1, &texture);
+}
+
+void GlState::Enable(unsigned int capability)
+{
+	if (SetEnabled(capability, true))
+	{
+		glEnable(capability);
+	}
+}
+
+void GlState::Disable(unsigned int capability)
+{
+	if (SetEnabled(capability, false))
+	{
+		glDisable(capability);
+	}
+}
+
+void GlState::CullFace(unsigned int face)
+{
+	if (Changes(cullFace, face))
+	{
+		glCullFace(face);
+	}
+}
+
+void GlState::DepthFunc(unsigned int func)
+{
+	if (Changes(depthFunc, func))
+	{
+		glDepthFunc(func);
+	}
+}
+
+void GlState::DepthMask(bool enabled)
+{
+	if (Changes(depthMask, enabled ? 1u : 0u))
+	{
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void GlState::ColorMask(bool enabled)
+{
+	if (Changes(colorMask, enabled ? 1u : 0u))
+	{
+		GLboolean value = enabled ? GL_TRUE : GL_FALSE;
+		glColorMask(value, value, value, value);
+	}
+}
+
+void GlState::Invalidate()
+{
+	program = unknown;
+	vao = unknown;
+	readFramebuffer = unknown;
+	drawFramebuffer = unknown;
+	viewportKnown = false;
+	activeTexture = unknown;
+	for (unsigned int(&unit)[(size_t)TextureTarget::Count] : textures)
+	{
+		std::fill(std::begin(unit), std::end(unit), unknown);
+	}
+	std::fill(std::begin(capabilities), std::end(capabilities), unknown);
+	cullFace = unknown;
+	depthFunc = unknown;
+	depthMask = unknown;
+	colorMask = unknown;
+}
+
+unsigned int GlState::GetSkippedCallCount()
+{
+	return nSkippedCalls;
+}
+
+void GlState::ResetSkippedCallCount()
+{
+	nSkippedCalls = 0;
+}
+
+int GlState::GetCapabilityIndex(unsigned int capability)
+{
+	switch (capability)
+	{
+	case GL_BLEND:
+		return (int)Capability::Blend;
+	case GL_CULL_FACE:
+		return (int)Capability::CullFace;
+	case GL_DEPTH_TEST:
+		return (int)Capability::DepthTest;
+	default:
+		return -1;
+	}
+}
+
+int GlState::GetTargetIndex(unsigned int target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D:
+		return (int)TextureTarget::Texture2D;
+	case GL_TEXTURE_2D_ARRAY:
+		return (int)TextureTarget::Texture2DArray;
+	case GL_TEXTURE_CUBE_MAP:
+		return (int)TextureTarget::CubeMap;
+	case GL_TEXTURE_BUFFER:
+		return (int)TextureTarget::Buffer;
+	default:
+		return -1;
+	}
+}
+
+bool GlState::SetEnabled(unsigned int capability, bool enabled)
+{
+	int index = GetCapabilityIndex(capability);
+	if (index < 0)
+	{
+		return true;
+	}
+	return Changes(capabilities[index], enabled ? 1u : 0u);
+}
+
+bool GlState::Changes(unsigned int& current, unsigned int value)
+{
+	if (current == value)
+	{
+		nSkippedCalls++;
+		return false;
+	}
+	current = value;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+
+//Shadow copy of the GL state that is changed most often: program, vao, framebuffers, viewport, texture bindings,
+//blending, culling and depth state. Setting something that is already set is skipped and counted instead of
+//reaching the driver. The copy is only right as long as every change goes through here, so don't call the
+//matching gl functions directly. Window invalidates the copy when it creates a context, so the first calls always reach GL.
+class GlState
+{
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vao);
+	//GL_FRAMEBUFFER binds both the read and the draw framebuffer
+	static void BindFramebuffer(unsigned int target, unsigned int fbo);
+	static void Viewport(int x, int y, int width, int height);
+	static void GetViewport(int viewport[4]);	//Without asking GL, unknown until Viewport is called
+
+	static void ActiveTexture(int unit);	//0 based, not GL_TEXTURE0 based
+	static void BindTexture(unsigned int target, unsigned int texture);	//To the active unit
+	static void DeleteTexture(unsigned int texture);	//Also forgets where it was bound, GL unbinds it
+
+	//Only GL_BLEND, GL_CULL_FACE and GL_DEPTH_TEST are tracked, anything else is passed on every time
+	static void Enable(unsigned int capability);
+	static void Disable(unsigned int capability);
+	static void CullFace(unsigned int face);
+	static void DepthFunc(unsigned int func);
+	static void DepthMask(bool enabled);
+	static void ColorMask(bool enabled);	//All channels at once
+
+	static void Invalidate();	//Forget everything, for a new context or code that changes state behind our back
+	static unsigned int GetSkippedCallCount();
+	static void ResetSkippedCallCount();
+private:
+	enum class Capability
+	{
+		Blend = 0,
+		CullFace,
+		DepthTest,
+		Count
+	};
+	enum class TextureTarget
+	{
+		Texture2D = 0,
+		Texture2DArray,
+		CubeMap,
+		Buffer,
+		Count
+	};
+private:
+	static int GetCapabilityIndex(unsigned int capability);	//-1 when not tracked
+	static int GetTargetIndex(unsigned int target);	//-1 when not tracked
+	static bool SetEnabled(unsigned int capability, bool enabled);	//Returns whether GL has to be called
+	static bool Changes(unsigned int& current, unsigned int value);	//Stores the new value, counts skipped calls
+private:
+	static constexpr unsigned int unknown = 0xFFFFFFFF;
+	static constexpr int nTextureUnits = 16;	//The minimum every GL 3.3 driver has for fragment shaders
+
+	static unsigned int program;
+	static unsigned int vao;
+	static unsigned int readFramebuffer;
+	static unsigned int drawFramebuffer;
+	static int viewport[4];
+	static bool viewportKnown;
+	static unsigned int activeTexture;
+	static unsigned int textures[nTextureUnits][(size_t)TextureTarget::Count];
+	static unsigned int capabilities[(size_t)Capability::Count];	//0 or 1 when known
+	static unsigned int cullFace;
+	static unsigned int depthFunc;
+	static unsigned int depthMask;
+	static unsigned int colorMask;
+
+	static unsigned int nSkippedCalls;
+};
\ No newline at end of file
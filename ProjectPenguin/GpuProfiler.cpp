@@ -0,0 +1,175 @@
+#include "GpuProfiler.h"
+
+#include <glad/glad.h>
+
+#include "json.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cassert>
+
+#include "GlGetError.h"
+
+GpuProfiler::~GpuProfiler()
+{
+	if (!allQueries.empty())
+	{
+		glDeleteQueries((GLsizei)allQueries.size(), allQueries.data());
+	}
+}
+
+void GpuProfiler::BeginFrame()
+{
+	currentFrame = (currentFrame + 1) % nFrames;
+
+	//Every other frame in the ring is newer, collect whatever has finished, oldest first
+	for (int i = 1; i < nFrames; i++)
+	{
+		CollectFrame((currentFrame + i) % nFrames);
+	}
+
+	//This slot is about to be reused, results that still aren't in by now are given up on
+	std::vector<Zone>& frame = frames[currentFrame];
+	if (!frame.empty())
+	{
+		nDroppedFrames++;
+		for (const Zone& zone : frame)
+		{
+			freeQueries.push_back(zone.startQuery);
+			freeQueries.push_back(zone.endQuery);
+		}
+		frame.clear();
+	}
+}
+
+void GpuProfiler::EndFrame()
+{
+	assert(openZones.empty());	//Every Begin needs an End
+	openZones.clear();
+}
+
+void GpuProfiler::Begin(const std::string& pass)
+{
+	Zone zone;
+	zone.pass = pass;
+	zone.startQuery = AcquireQuery();
+	zone.endQuery = AcquireQuery();
+	glQueryCounter(zone.startQuery, GL_TIMESTAMP);
+
+	openZones.push_back(frames[currentFrame].size());
+	frames[currentFrame].push_back(zone);
+}
+
+void GpuProfiler::End()
+{
+	assert(!openZones.empty());
+	unsigned int endQuery = frames[currentFrame][openZones.back()].endQuery;
+	glQueryCounter(endQuery, GL_TIMESTAMP);
+	lastEndQueries[currentFrame] = endQuery;
+	openZones.pop_back();
+}
+
+void GpuProfiler::AddSample(const std::string& pass, float ms)
+{
+	PassTimings& passTimings = timings[pass];
+	passTimings.lastMs = ms;
+	passTimings.averageMs = passTimings.nSamples == 0 ? ms : passTimings.averageMs + (ms - passTimings.averageMs) * smoothing;
+	passTimings.maxMs = std::max(passTimings.maxMs, ms);
+	passTimings.nSamples++;
+
+	if (passTimings.history.size() < historySize)
+	{
+		passTimings.history.push_back(ms);
+	}
+	else
+	{
+		passTimings.history[passTimings.historyStart] = ms;
+		passTimings.historyStart = (passTimings.historyStart + 1) % historySize;
+	}
+}
+
+const std::map<std::string, GpuProfiler::PassTimings>& GpuProfiler::GetTimings() const
+{
+	return timings;
+}
+
+void GpuProfiler::Dump(std::string fileName) const
+{
+	nlohmann::json data;
+	data["droppedFrames"] = nDroppedFrames;
+	for (const std::pair<const std::string, PassTimings>& element : timings)
+	{
+		const PassTimings& passTimings = element.second;
+
+		//Oldest sample first
+		std::vector<float> samples;
+		samples.insert(samples.end(), passTimings.history.begin() + passTimings.historyStart, passTimings.history.end());
+		samples.insert(samples.end(), passTimings.history.begin(), passTimings.history.begin() + passTimings.historyStart);
+
+		data["passes"][element.first] = {
+			{"averageMs", passTimings.averageMs},
+			{"maxMs", passTimings.maxMs},
+			{"nSamples", passTimings.nSamples},
+			{"samplesMs", samples}
+		};
+	}
+
+	std::string filePath = "UserData/";
+	filePath.append(fileName);
+	std::ofstream file(filePath);
+	file << std::setw(4) << data << std::endl;
+}
+
+unsigned int GpuProfiler::AcquireQuery()
+{
+	if (freeQueries.empty())
+	{
+		unsigned int newQueries[queryBatchSize];
+		glGenQueries(queryBatchSize, newQueries);
+		freeQueries.insert(freeQueries.end(), newQueries, newQueries + queryBatchSize);
+		allQueries.insert(allQueries.end(), newQueries, newQueries + queryBatchSize);
+		GL_ERROR_CHECK();
+	}
+	unsigned int query = freeQueries.back();
+	freeQueries.pop_back();
+	return query;
+}
+
+void GpuProfiler::CollectFrame(int frame)
+{
+	std::vector<Zone>& zones = frames[frame];
+	if (zones.empty())
+	{
+		return;
+	}
+
+	//Queries complete in the order they were issued, so if the last one is available the whole frame is
+	GLint available = GL_FALSE;
+	glGetQueryObjectiv(lastEndQueries[frame], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == GL_FALSE)
+	{
+		return;
+	}
+
+	//A pass that runs several times in a frame (e.g. one per canvas) counts as the sum of its runs
+	std::map<std::string, float> frameTimings;
+	for (const Zone& zone : zones)
+	{
+		GLuint64 start = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(zone.startQuery, GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+		frameTimings[zone.pass] += (float)(end - start) / 1000000.0f;
+
+		freeQueries.push_back(zone.startQuery);
+		freeQueries.push_back(zone.endQuery);
+	}
+	zones.clear();
+	GL_ERROR_CHECK();
+
+	for (const std::pair<const std::string, float>& element : frameTimings)
+	{
+		AddSample(element.first, element.second);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+//Measures how long the GPU spends on each pass of a frame with timestamp queries.
+//Results are read back a few frames late, only once the GPU reports them available, so profiling never stalls the pipeline.
+//Passes can be nested, every Begin needs a matching End in the same frame.
+class GpuProfiler
+{
+public:
+	//Rolling timings of one pass, in milliseconds
+	struct PassTimings
+	{
+		float lastMs = 0.0f;
+		float averageMs = 0.0f;
+		float maxMs = 0.0f;
+		unsigned int nSamples = 0;
+		std::vector<float> history;	//Ring buffer of the latest samples, oldest at historyStart
+		size_t historyStart = 0;
+	};
+public:
+	GpuProfiler() = default;
+	~GpuProfiler();
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler operator=(const GpuProfiler&) = delete;
+
+	void BeginFrame();	//Collects the results of earlier frames that have finished
+	void EndFrame();
+	void Begin(const std::string& pass);
+	void End();
+
+	void AddSample(const std::string& pass, float ms);
+	const std::map<std::string, PassTimings>& GetTimings() const;
+	void Dump(std::string fileName) const;	//Writes the timings to UserData as json
+private:
+	struct Zone
+	{
+		std::string pass;
+		unsigned int startQuery = 0;
+		unsigned int endQuery = 0;
+	};
+private:
+	unsigned int AcquireQuery();
+	void CollectFrame(int frame);
+private:
+	static constexpr int nFrames = 4;	//Frames the results may lag behind, queries of older frames that aren't done are dropped
+	static constexpr size_t historySize = 300;
+	static constexpr float smoothing = 0.05f;	//Weight of the latest sample in the average
+	static constexpr int queryBatchSize = 32;	//Queries are generated this many at a time
+
+	std::vector<Zone> frames[nFrames];
+	unsigned int lastEndQueries[nFrames] = {};	//Per frame, the end query that was issued last. With nesting this isn't the one of the last zone
+	int currentFrame = 0;
+	std::vector<size_t> openZones;	//Zones of the current frame that haven't ended yet
+	std::vector<unsigned int> freeQueries;	//The pool
+	std::vector<unsigned int> allQueries;
+
+	std::map<std::string, PassTimings> timings;
+	unsigned int nDroppedFrames = 0;
+};
\ No newline at end of file
@@ -9,42 +9,33 @@ IceRink::IceRink(bool initModels)
 	:
 	ferrisWheelRotationAndTranslationMat(glm::translate(glm::mat4(1.0f), glm::vec3(30.1384f, 8.02308f, -8.90442f))
 		* glm::rotate(glm::mat4(1.0f), -0.527923701f, glm::vec3(0.0f, 1.0f, 0.0f))),
-	carouselTranslation(glm::translate(glm::mat4(1.0f), glm::vec3(-30.15f, -0.21f, 4.49f)))
+	carouselTranslation(glm::translate(glm::mat4(1.0f), glm::vec3(-30.15f, -0.21f, 4.49f))),
+	lightClusters(simpleLightRadius),
+	blobShadows(glm::vec2(0.0f), glm::vec2(right + 1.0f, top + 1.0f))
 {
 	if (initModels)
 	{
 		InitModels();
 	}
+	lightSources = GetBakedLights().positions;
 
-	lightSources.emplace_back(-14.29f, 2.64f, -16.96f);		//Left lantern
-	lightSources.emplace_back(-4.28f, 2.64f, -17.9f);		//Middle left lantern
-	lightSources.emplace_back(4.54f, 2.61f, -20.86f);		//Middle right lantern
-	lightSources.emplace_back(12.8f, 2.64f, -15.97f);		//Right lantern
-	lightSources.emplace_back(-28.13f, 3.77f, -12.23f);		//Left house0
-
-	lightSources.emplace_back(-31.32f, 3.77f, -10.29f);		//Left house1
-	lightSources.emplace_back(9.65f, 2.2f, -15.83f);		//Right house (bottom)
-	lightSources.emplace_back(6.77f, 1.93f, -16.7f);		//Right house (top)
-	lightSources.emplace_back(-0.76f, 3.42f, -18.30f);		//Middle house
-	lightSources.emplace_back(30.13f, 8.02f, -8.90f);		//Ferris wheel
-	
-	lightSources.emplace_back(-30.15f, 2.6f, 4.49f);		//Carousel middle
-	lightSources.emplace_back(-27.27f, 2.45f, -4.33f);		//Choir
-	lightSources.emplace_back(28.0f, 2.0f, 0.67f);			//Far right lantern
-	lightSources.emplace_back(-27.15f, 3.0f, 4.49f);			//Carousel right
-	lightSources.emplace_back(-30.15f, 3.0f, 7.0f);			//Carousel front
-
-
-	//REPLACE: Would be better if these could all use the same shader (EXCEPT THE BACKGROUND!!!)
-	for (Model& m : staticSurroundings)
+	//The light positions and clusters are uploaded every frame, the programs only need to know where to find the clusters
+	if (staticSurroundings)
 	{
-		m.GetShader().Use();
-		m.GetShader().SetUniformInt("nSimpleLights", (int)lightSources.size());
-		m.GetShader().SetUniformVec3Array("simpleLights", lightSources);
+		for (const Shader* shader : staticSurroundings->GetShaders())
+		{
+			shader->Use();
+			shader->SetUniformInt("lightClusters", LightClusters::textureUnit);
+		}
 	}
 	carousel->GetShader().Use();
-	carousel->GetShader().SetUniformInt("nSimpleLights", (int)lightSources.size());
-	carousel->GetShader().SetUniformVec3Array("simpleLights", lightSources);
+	carousel->GetShader().SetUniformInt("lightClusters", LightClusters::textureUnit);
+	ferrisWheel->GetShader().Use();
+	ferrisWheel->GetShader().SetUniformInt("lightClusters", LightClusters::textureUnit);
+
+	iceModel->GetShader().Use();
+	iceModel->GetShader().SetUniformInt("blobShadows", BlobShadows::textureUnit);
+	iceModel->GetShader().SetUniformVec4("blobShadowArea", blobShadows.GetArea());
 
 	transform = glm::mat4(1.0f);
 
@@ -69,44 +60,31 @@ IceRink::IceRink(bool initModels)
 
 void IceRink::DrawStatic(Camera& camera)
 {
-	for (Model& m : staticSurroundings)
-	{
-		m.AddToRenderQueue(camera);
-	}
+	staticSurroundings->AddToRenderQueue(camera);
 }
 
-void IceRink::DrawNonStatic(Camera& camera, const std::vector<glm::vec3>& collectiblePositions)
+void IceRink::DrawNonStatic(Camera& camera)
 {
-	//Bind uniforms for ice shader 
-	iceModel->GetShader().Use();
-	iceModel->GetShader().SetUniformInt("nCollectibles", (int)collectiblePositions.size());
-	if (!collectiblePositions.empty())
-	{
-		iceModel->GetShader().SetUniformVec3Array("collectibles", collectiblePositions);
-	}
-	//Draw
+	//The ice samples the blob shadows, so they are rendered before the ice is drawn
+	blobShadows.Render();
 	iceModel->AddToRenderQueue(camera);
 	iceHole->AddToRenderQueue(camera);
 
-	//Calculate light source locations for ferris wheel
-	std::vector<glm::vec3> ferrisWheelLights;
-	ferrisWheelLights.resize(ferrisWheelCartTransforms.size());
-	for (int i = 0; i < ferrisWheelCartTransforms.size(); i++)
+	//Add the lights of the ferris wheel carts to the fixed lights and bin them all into clusters
+	//The fixed lights come first, so lightmapped surroundings can skip them
+	frameLights = lightSources;
+	for (const glm::mat4& cartTransform : ferrisWheelCartTransforms)
 	{
-		ferrisWheelLights[i] = glm::vec3(ferrisWheelCartTransforms[i] * glm::vec4(0.0f, -2.0f, 1.0f, 1.0f));
+		frameLights.emplace_back(cartTransform * glm::vec4(0.0f, -2.0f, 1.0f, 1.0f));
 	}
+	lightClusters.Build(frameLights, (int)lightSources.size());
+	lightClusters.Upload();
 
 	//Draw ferris wheel
-	ferrisWheel->GetShader().Use();
-	ferrisWheel->GetShader().SetUniformInt("nSimpleLights", (int)ferrisWheelLights.size());
-	ferrisWheel->GetShader().SetUniformVec3Array("simpleLights", ferrisWheelLights);
 	ferrisWheel->AddToRenderQueue(camera);
 	
 	for (Model& m : ferrisWheelCarts)
 	{
-		m.GetShader().Use();
-		m.GetShader().SetUniformInt("nSimpleLights", (int)ferrisWheelLights.size());
-		m.GetShader().SetUniformVec3Array("simpleLights", ferrisWheelLights);
 		m.AddToRenderQueue(camera);
 	}
 
@@ -121,6 +99,11 @@ void IceRink::DrawNonStatic(Camera& camera, const std::vector<glm::vec3>& collec
 	}
 }
 
+void IceRink::AddBlobShadow(glm::vec3 position)
+{
+	blobShadows.Add(position);
+}
+
 void IceRink::Reset()
 {
 	//Reset ice location
@@ -217,38 +200,25 @@ void IceRink::SetIcePos(glm::vec3 newPos)
 void IceRink::InitModels()
 {
 	//Ice
-	iceModel = std::make_unique<Model>("Ice.gltf", iceTransform, "SmoothShader.vert", "IceShader.frag");
+	iceModel = std::make_unique<Model>("Ice.gltf", iceTransform, "SmoothShaderInstanced.vert", "IceShader.frag");
 	iceHole = std::make_unique<Model>("IceHole.gltf", iceTransform);
 	
 	//Surroundings
-	staticSurroundings.emplace_back("Ground.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("Market.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("Lamps.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("Trees.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("Restaurant.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("Mountains.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("BackgroundHouses.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("House.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("Benches.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("Snowmen.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("ChoirStand.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("FerrisWheelBase.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("CarouselBase.gltf", transform, "SmoothShader.vert", "Surroundings.frag");
-	staticSurroundings.emplace_back("BlackBox.gltf", transform, "SmoothShader.vert", "Background.frag");
+	staticSurroundings = std::make_unique<StaticBatch>("Surroundings", transform, GetSurroundingParts(), GetBakedLights());
 
 	//Animations
-	ferrisWheel = std::make_unique<Model>("FerrisWheel.gltf", ferrisWheelTransform, "SmoothShader.vert", "Surroundings.frag");
+	ferrisWheel = std::make_unique<Model>("FerrisWheel.gltf", ferrisWheelTransform, "SmoothShaderInstanced.vert", "Surroundings.frag");
 	ferrisWheelCartTransforms.resize(8);
-	ferrisWheelCarts.emplace_back("FerrisWheelCart1.gltf", ferrisWheelCartTransforms[0], "SmoothShader.vert", "Surroundings.frag");
-	ferrisWheelCarts.emplace_back("FerrisWheelCart2.gltf", ferrisWheelCartTransforms[1], "SmoothShader.vert", "Surroundings.frag");
-	ferrisWheelCarts.emplace_back("FerrisWheelCart3.gltf", ferrisWheelCartTransforms[2], "SmoothShader.vert", "Surroundings.frag");
-	ferrisWheelCarts.emplace_back("FerrisWheelCart4.gltf", ferrisWheelCartTransforms[3], "SmoothShader.vert", "Surroundings.frag");
-	ferrisWheelCarts.emplace_back("FerrisWheelCart1.gltf", ferrisWheelCartTransforms[4], "SmoothShader.vert", "Surroundings.frag");
-	ferrisWheelCarts.emplace_back("FerrisWheelCart2.gltf", ferrisWheelCartTransforms[5], "SmoothShader.vert", "Surroundings.frag");
-	ferrisWheelCarts.emplace_back("FerrisWheelCart3.gltf", ferrisWheelCartTransforms[6], "SmoothShader.vert", "Surroundings.frag");
-	ferrisWheelCarts.emplace_back("FerrisWheelCart4.gltf", ferrisWheelCartTransforms[7], "SmoothShader.vert", "Surroundings.frag");
+	ferrisWheelCarts.emplace_back("FerrisWheelCart1.gltf", ferrisWheelCartTransforms[0], "SmoothShaderInstanced.vert", "Surroundings.frag");
+	ferrisWheelCarts.emplace_back("FerrisWheelCart2.gltf", ferrisWheelCartTransforms[1], "SmoothShaderInstanced.vert", "Surroundings.frag");
+	ferrisWheelCarts.emplace_back("FerrisWheelCart3.gltf", ferrisWheelCartTransforms[2], "SmoothShaderInstanced.vert", "Surroundings.frag");
+	ferrisWheelCarts.emplace_back("FerrisWheelCart4.gltf", ferrisWheelCartTransforms[3], "SmoothShaderInstanced.vert", "Surroundings.frag");
+	ferrisWheelCarts.emplace_back("FerrisWheelCart1.gltf", ferrisWheelCartTransforms[4], "SmoothShaderInstanced.vert", "Surroundings.frag");
+	ferrisWheelCarts.emplace_back("FerrisWheelCart2.gltf", ferrisWheelCartTransforms[5], "SmoothShaderInstanced.vert", "Surroundings.frag");
+	ferrisWheelCarts.emplace_back("FerrisWheelCart3.gltf", ferrisWheelCartTransforms[6], "SmoothShaderInstanced.vert", "Surroundings.frag");
+	ferrisWheelCarts.emplace_back("FerrisWheelCart4.gltf", ferrisWheelCartTransforms[7], "SmoothShaderInstanced.vert", "Surroundings.frag");
 
-	carousel = std::make_unique<Model>("CarouselHorses.gltf", carouselTransform, "SmoothShader.vert", "Surroundings.frag");	//Import the puppies
+	carousel = std::make_unique<Model>("CarouselHorses.gltf", carouselTransform, "SmoothShaderInstanced.vert", "Surroundings.frag");	//Import the puppies
 
 	const int nSnowPenguins = 4;
 	snowBallTransforms.resize(nSnowPenguins);
@@ -263,3 +233,53 @@ void IceRink::InitModels()
 		snowBallCurveTimes.emplace_back(100.0f);	//Snowballs start way off screen
 	}
 }
+
+void IceRink::BakeLightmaps()
+{
+	StaticBatch::BakeLightmaps(GetSurroundingParts(), GetBakedLights());
+}
+
+std::vector<StaticBatch::Part> IceRink::GetSurroundingParts()
+{
+	std::vector<StaticBatch::Part> surroundings;
+	surroundings.push_back({ "Ground.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "Market.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "Lamps.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "Trees.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "Restaurant.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "Mountains.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "BackgroundHouses.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "House.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "Benches.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "Snowmen.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "ChoirStand.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "FerrisWheelBase.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "CarouselBase.gltf", "SmoothShaderInstanced.vert", "Surroundings.frag", true });
+	surroundings.push_back({ "BlackBox.gltf", "SmoothShaderInstanced.vert", "Background.frag" });
+	return surroundings;
+}
+
+Lightmap::Lights IceRink::GetBakedLights()
+{
+	//These never move, so they are baked into the lightmaps of the surroundings
+	Lightmap::Lights lights;
+	lights.radius = simpleLightRadius;
+	lights.positions.emplace_back(-14.29f, 2.64f, -16.96f);		//Left lantern
+	lights.positions.emplace_back(-4.28f, 2.64f, -17.9f);		//Middle left lantern
+	lights.positions.emplace_back(4.54f, 2.61f, -20.86f);		//Middle right lantern
+	lights.positions.emplace_back(12.8f, 2.64f, -15.97f);		//Right lantern
+	lights.positions.emplace_back(-28.13f, 3.77f, -12.23f);		//Left house0
+
+	lights.positions.emplace_back(-31.32f, 3.77f, -10.29f);		//Left house1
+	lights.positions.emplace_back(9.65f, 2.2f, -15.83f);		//Right house (bottom)
+	lights.positions.emplace_back(6.77f, 1.93f, -16.7f);		//Right house (top)
+	lights.positions.emplace_back(-0.76f, 3.42f, -18.30f);		//Middle house
+	lights.positions.emplace_back(30.13f, 8.02f, -8.90f);		//Ferris wheel
+	
+	lights.positions.emplace_back(-30.15f, 2.6f, 4.49f);		//Carousel middle
+	lights.positions.emplace_back(-27.27f, 2.45f, -4.33f);		//Choir
+	lights.positions.emplace_back(28.0f, 2.0f, 0.67f);			//Far right lantern
+	lights.positions.emplace_back(-27.15f, 3.0f, 4.49f);			//Carousel right
+	lights.positions.emplace_back(-30.15f, 3.0f, 7.0f);			//Carousel front
+	return lights;
+}
\ No newline at end of file
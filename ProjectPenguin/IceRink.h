@@ -4,6 +4,9 @@
 
 #include "Model.h"
 #include "AnimatedModel.h"
+#include "StaticBatch.h"
+#include "LightClusters.h"
+#include "BlobShadows.h"
 
 #include <memory>
 
@@ -18,7 +21,8 @@ public:
 	IceRink(bool initModels = true);
 
 	void DrawStatic(Camera& camera);
-	void DrawNonStatic(Camera& camera, const std::vector<glm::vec3>& collectiblePositions);
+	void DrawNonStatic(Camera& camera);
+	void AddBlobShadow(glm::vec3 position);	//Cast on the ice by the next DrawNonStatic
 	void Reset();
 	void Update(float deltaTime);
 	void UpdateFerrisWheelAndCarousel(float deltaTime);
@@ -28,8 +32,13 @@ public:
 	float GetCornerRadius() const;
 
 	void SetIcePos(glm::vec3 newPos);
+
+	//Bakes the fixed lights into the lightmaps of the surroundings, doesn't need a window or GPU
+	static void BakeLightmaps();
 private:
 	void InitModels();
+	static std::vector<StaticBatch::Part> GetSurroundingParts();
+	static Lightmap::Lights GetBakedLights();
 private:
 	//Dimensions
 	static constexpr float right = 24.6f;
@@ -44,8 +53,8 @@ private:
 	std::unique_ptr<Model> iceModel;
 	std::unique_ptr<Model> iceHole;
 
-	//Surroundings
-	std::vector<Model> staticSurroundings;
+	//Surroundings, these never move so they are merged into one batch
+	std::unique_ptr<StaticBatch> staticSurroundings;
 
 	//Animations
 	std::unique_ptr<Model> ferrisWheel;
@@ -73,6 +82,10 @@ private:
 	int activeSnowPenguinIndex = 0;
 
 	//Lights
-	std::vector<glm::vec3> lightSources;
-	std::vector<glm::vec3> ferrisWheelLightSources;
+	std::vector<glm::vec3> lightSources;	//Fixed, baked into the lightmaps of the surroundings
+	std::vector<glm::vec3> frameLights;	//The fixed lights plus the lights on the ferris wheel carts
+	static constexpr float simpleLightRadius = 3.0f;
+	LightClusters lightClusters;
+
+	BlobShadows blobShadows;
 };
\ No newline at end of file
@@ -1,54 +1,76 @@
 #include "Light.h"
 
+#include "AnimatedModel.h"
+
 #include "glad/glad.h"
 #include "glm/gtc/matrix_transform.hpp"
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "SaveFile.h"
+#include "GlGetError.h"
+#include "GlState.h"
+
 Light::Light(glm::vec3 pos, unsigned int shadowResolution)
 	:
 	pos(pos),
 	shadowResolutionX(shadowResolution),
 	shadowResolutionY(shadowResolution),
-	nonAnimationShader("DepthOnly.vert", "DepthOnly.frag", "DepthOnly.geom"),
+	nonAnimationShader("DepthOnlyInstanced.vert", "DepthOnly.frag", "DepthOnly.geom"),
 	animationShader("DepthOnlyAnimation.vert", "DepthOnly.frag", "DepthOnly.geom"),
-	lightTransform(CalculateLightTransform(pos))
+	lightTransform(CalculateLightTransform(pos)),
+	lightConstants(UniformBlock::LightConstants, sizeof(LightConstants)),
+	shadowMatrices(UniformBlock::ShadowMatrices, sizeof(ShadowMatrices))
 {
-	//Create depth map FBO
+	//Create depth map FBO, and a second one to read the baked shadows from when they're copied
 	glGenFramebuffers(1, &depthMapFBO);
+	glGenFramebuffers(1, &bakedCopyFBO);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, bakedCopyFBO);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
-	//Create depth cubemap
+	//Create depth cubemap, this holds the baked shadows with the dynamic shadows drawn on top.
+	//Depth is linear (distance / far plane), so 16 bits are precise enough and half the size of floats
 	glGenTextures(1, &depthCubeMap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMap);
+	GlState::BindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMap);
 	for (unsigned int i = 0; i < 6; ++i)
 	{
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i
 			, 0
-			, GL_DEPTH_COMPONENT
+			, GL_DEPTH_COMPONENT16
 			, shadowResolutionX
 			, shadowResolutionY
 			, 0
 			, GL_DEPTH_COMPONENT
-			, GL_FLOAT
+			, GL_UNSIGNED_SHORT
 			, NULL);
 	}
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	//Lit shaders sample this as a samplerCubeShadow, linear filtering blends the comparisons of the 4 nearest texels
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
 
 	//Create baked depth cubemap REPLACE: hardcode shadowRes? If yes, REPLACE GetShadowRes() to scale viewPort correctly!!!
+	//It's never sampled, only copied into the depth cubemap, so the formats have to match exactly
 	glGenTextures(1, &depthCubeMapBaked);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMapBaked);
+	GlState::BindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMapBaked);
 	for (unsigned int i = 0; i < 6; ++i)
 	{
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i
 			, 0
-			, GL_DEPTH_COMPONENT
+			, GL_DEPTH_COMPONENT16
 			, shadowResolutionX
 			, shadowResolutionY
 			, 0
 			, GL_DEPTH_COMPONENT
-			, GL_FLOAT
+			, GL_UNSIGNED_SHORT
 			, NULL);
 	}
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -56,6 +78,25 @@ Light::Light(glm::vec3 pos, unsigned int shadowResolution)
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+	for (int face = 0; face < 6; face++)
+	{
+		faceFrusta[face] = EliMath::ExtractFrustum(lightTransform[face]);
+	}
+
+	//Upload light constants, these are shared by the depth shaders and all lit shaders
+	lightConstants.Update(LightConstants{ pos, farPlane });
+	ShadowMatrices shadowMatricesData;
+	std::copy(lightTransform.begin(), lightTransform.end(), shadowMatricesData.shadowMatrices);
+	shadowMatrices.Update(shadowMatricesData);
+
+	animationShader.Use();
+	animationShader.SetUniformInt("skinnedVertices", AnimatedModel::skinnedVertexTextureUnit);
+
+	nonAnimationActiveFacesHandle = nonAnimationShader.GetUniformHandle("activeFaces");
+	animationActiveFacesHandle = animationShader.GetUniformHandle("activeFaces");
+	SetActiveFaces(allFaces);
+	BeginShadowCasters();
 }
 
 void Light::UseNonAnimationShader() const
@@ -68,22 +109,36 @@ void Light::UseAnimationShader() const
 	animationShader.Use();
 }
 
+void Light::BindUniformBuffers() const
+{
+	lightConstants.Bind();
+	shadowMatrices.Bind();
+}
+
+void Light::BindShadowMaps() const
+{
+	//Lit shaders sample the combined shadows from unit 1
+	GlState::ActiveTexture(1);
+	GlState::BindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMap);
+	GlState::ActiveTexture(0);
+}
+
 void Light::UseBakeTexture() const
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
 	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubeMapBaked, 0);
 	glDrawBuffer(GL_NONE);
 	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void Light::UseNonBakeTexture() const
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
 	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubeMap, 0);
 	glDrawBuffer(GL_NONE);
 	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 int Light::GetShadowResolutionX() const
@@ -121,7 +176,7 @@ glm::vec3 Light::GetPos() const
 	return pos;
 }
 
-std::vector<glm::mat4> Light::GetShadowMatrices() const
+const std::vector<glm::mat4>& Light::GetShadowMatrices() const
 {
 	return lightTransform;
 }
@@ -136,6 +191,182 @@ const Shader& Light::GetNonAnimationShader() const
 	return nonAnimationShader;
 }
 
+int Light::GetFaceMask(const EliMath::BoundingSphere& sphere) const
+{
+	int result = 0;
+	for (int face = 0; face < 6; face++)
+	{
+		if (EliMath::IsInFrustum(faceFrusta[face], sphere))
+		{
+			result |= 1 << face;
+		}
+	}
+	return result;
+}
+
+void Light::BeginShadowCasters()
+{
+	for (uint64_t& signature : casterSignatures)
+	{
+		signature = EliMath::HashBytes(nullptr, 0);
+	}
+}
+
+void Light::AddShadowCaster(int faceMask, uint64_t casterHash)
+{
+	for (int face = 0; face < 6; face++)
+	{
+		if (faceMask & (1 << face))
+		{
+			casterSignatures[face] = EliMath::HashBytes(&casterHash, sizeof(casterHash), casterSignatures[face]);
+		}
+	}
+}
+
+uint64_t Light::GetShadowCasterSignature() const
+{
+	return EliMath::HashBytes(casterSignatures, sizeof(casterSignatures));
+}
+
+int Light::UpdateDirtyFaces()
+{
+	int result = forcedDirtyFaces;
+	for (int face = 0; face < 6; face++)
+	{
+		if (casterSignatures[face] != renderedSignatures[face])
+		{
+			result |= 1 << face;
+		}
+		renderedSignatures[face] = casterSignatures[face];
+	}
+	forcedDirtyFaces = 0;
+	return result;
+}
+
+void Light::ResetDynamicFaces(int faceMask) const
+{
+	//Blits only copy the first layer of a layered attachment, so the faces are attached one by one,
+	//after which the whole cube map is attached again for layered rendering
+	GlState::BindFramebuffer(GL_READ_FRAMEBUFFER, bakedCopyFBO);
+	for (int face = 0; face < 6; face++)
+	{
+		if (faceMask & (1 << face))
+		{
+			glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, depthCubeMapBaked, 0);
+			glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, depthCubeMap, 0);
+			glBlitFramebuffer(0, 0, shadowResolutionX, shadowResolutionY,
+				0, 0, shadowResolutionX, shadowResolutionY,
+				GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		}
+	}
+	GlState::BindFramebuffer(GL_READ_FRAMEBUFFER, depthMapFBO);
+	glFramebufferTexture(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubeMap, 0);
+	GL_ERROR_CHECK();
+}
+
+void Light::SetActiveFaces(int faceMask) const
+{
+	nonAnimationShader.Use();
+	nonAnimationShader.Set(nonAnimationActiveFacesHandle, faceMask);
+	animationShader.Use();
+	animationShader.Set(animationActiveFacesHandle, faceMask);
+}
+
+void Light::SetShadowUpdateInterval(int nFrames)
+{
+	shadowUpdateInterval = std::max(nFrames, 1);
+}
+
+bool Light::ShouldUpdateShadows()
+{
+	if (framesUntilShadowUpdate > 0)
+	{
+		framesUntilShadowUpdate--;
+		return false;
+	}
+	framesUntilShadowUpdate = shadowUpdateInterval - 1;
+	return true;
+}
+
+bool Light::LoadBakedShadows(std::string fileName, uint64_t signature) const
+{
+	if (!SaveFile::FileExists(fileName))
+	{
+		return false;
+	}
+
+	std::string filePath = "UserData/";
+	filePath.append(fileName);
+	std::ifstream file(filePath, std::ios::binary);
+
+	//Header: version, key and resolution all have to match
+	uint32_t version = 0;
+	uint64_t key = 0;
+	uint32_t resolution = 0;
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&key), sizeof(key));
+	file.read(reinterpret_cast<char*>(&resolution), sizeof(resolution));
+	if (!file || version != bakedShadowsVersion || key != CalculateBakedShadowsKey(signature) || resolution != shadowResolutionX)
+	{
+		std::cout << "Baked shadows in " << fileName << " are out of date" << std::endl;
+		return false;
+	}
+
+	//Depth is stored as 16 bit per texel, which is plenty for a light with a far plane of 80
+	std::vector<unsigned short> faceData((size_t)shadowResolutionX * shadowResolutionY);
+	GlState::BindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMapBaked);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+	for (unsigned int i = 0; i < 6 && file; ++i)
+	{
+		file.read(reinterpret_cast<char*>(faceData.data()), faceData.size() * sizeof(unsigned short));
+		if (file)
+		{
+			glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, 0, 0, shadowResolutionX, shadowResolutionY, GL_DEPTH_COMPONENT, GL_UNSIGNED_SHORT, faceData.data());
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GL_ERROR_CHECK();
+
+	if (!file)
+	{
+		std::cout << "Baked shadows in " << fileName << " are incomplete" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void Light::SaveBakedShadows(std::string fileName, uint64_t signature) const
+{
+	std::string filePath = "UserData/";
+	filePath.append(fileName);
+	std::ofstream file(filePath, std::ios::binary);
+
+	uint32_t version = bakedShadowsVersion;
+	uint64_t key = CalculateBakedShadowsKey(signature);
+	uint32_t resolution = shadowResolutionX;
+	file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+	file.write(reinterpret_cast<const char*>(&resolution), sizeof(resolution));
+
+	std::vector<unsigned short> faceData((size_t)shadowResolutionX * shadowResolutionY);
+	GlState::BindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMapBaked);
+	glPixelStorei(GL_PACK_ALIGNMENT, 2);
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_SHORT, faceData.data());
+		file.write(reinterpret_cast<const char*>(faceData.data()), faceData.size() * sizeof(unsigned short));
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	GL_ERROR_CHECK();
+}
+
+uint64_t Light::CalculateBakedShadowsKey(uint64_t signature) const
+{
+	//The shadow map also depends on the light itself
+	float lightProperties[5] = { pos.x, pos.y, pos.z, nearPlane, farPlane };
+	return EliMath::HashBytes(lightProperties, sizeof(lightProperties), signature);
+}
+
 std::vector<glm::mat4> Light::CalculateLightTransform(glm::vec3 pos) const
 {
 	//Calculate perspective
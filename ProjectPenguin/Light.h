@@ -3,6 +3,10 @@
 #include "glm/glm.hpp"
 
 #include "Shader.h"
+#include "UniformBuffer.h"
+#include "EliMath.h"
+
+#include <string>
 
 class Light
 {
@@ -13,6 +17,8 @@ public:
 	void UseAnimationShader() const;
 	void UseBakeTexture() const;
 	void UseNonBakeTexture() const;
+	void BindUniformBuffers() const;
+	void BindShadowMaps() const;
 
 	int GetShadowResolutionX() const;
 	int GetShadowResolutionY() const;
@@ -21,11 +27,34 @@ public:
 	unsigned int GetShadowCubeMap() const;
 	unsigned int GetBakedShadowCubeMap() const;
 	glm::vec3 GetPos() const;
-	std::vector<glm::mat4> GetShadowMatrices() const;
+	const std::vector<glm::mat4>& GetShadowMatrices() const;
 	const Shader& GetAnimationShader() const;
 	const Shader& GetNonAnimationShader() const;
+
+	//Bitmask of the cube map faces the sphere overlaps, casters are only drawn to these faces.
+	//0 means the sphere is out of range and can't cast a shadow at all
+	int GetFaceMask(const EliMath::BoundingSphere& sphere) const;
+
+	//Shadow caching, every caster reports a hash of its state so unchanged faces of the cube map can be skipped
+	void BeginShadowCasters();
+	void AddShadowCaster(int faceMask, uint64_t casterHash);
+	uint64_t GetShadowCasterSignature() const;	//Combined hash of every caster reported since BeginShadowCasters
+	int UpdateDirtyFaces();	//Returns the faces whose casters changed since they were last rendered
+	void ResetDynamicFaces(int faceMask) const;	//Copies the baked shadows into these faces, expects the shadow FBO to be bound
+	void SetActiveFaces(int faceMask) const;	//Faces the depth shaders draw to
+
+	//Dynamic shadows are only rendered once every nFrames
+	void SetShadowUpdateInterval(int nFrames);
+	bool ShouldUpdateShadows();
+
+	//Baked shadows are stored in UserData, they're only valid for the exact same static casters
+	bool LoadBakedShadows(std::string fileName, uint64_t signature) const;
+	void SaveBakedShadows(std::string fileName, uint64_t signature) const;
+public:
+	static constexpr int allFaces = 0x3F;
 private:
 	std::vector<glm::mat4> CalculateLightTransform(glm::vec3 pos) const;
+	uint64_t CalculateBakedShadowsKey(uint64_t signature) const;
 private:
 	const unsigned int shadowResolutionX = 512;
 	const unsigned int shadowResolutionY = 512;
@@ -35,11 +64,28 @@ private:
 
 	Shader nonAnimationShader;
 	Shader animationShader;
+	UniformHandle nonAnimationActiveFacesHandle;
+	UniformHandle animationActiveFacesHandle;
 
 	unsigned int depthMapFBO;
+	unsigned int bakedCopyFBO;
 	unsigned int depthCubeMap;
 	unsigned int depthCubeMapBaked;
 
 	const glm::vec3 pos;
 	const std::vector<glm::mat4> lightTransform;
+	EliMath::Frustum faceFrusta[6];	//Frustum of every cube map face, in the same order as lightTransform
+
+	//The light never moves, so these are only uploaded once
+	UniformBuffer lightConstants;
+	UniformBuffer shadowMatrices;
+
+	//Shadow caching
+	uint64_t casterSignatures[6];	//Per face, hash of the casters reported this frame
+	uint64_t renderedSignatures[6] = {};	//Per face, hash of the casters currently in the dynamic shadow map
+	int forcedDirtyFaces = allFaces;	//Nothing has been rendered yet
+	int shadowUpdateInterval = 1;
+	int framesUntilShadowUpdate = 0;
+
+	static constexpr uint32_t bakedShadowsVersion = 2;	//Increase whenever the depth shaders or the file layout change
 };
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "LightClusters.h"
+
+#include <glad/glad.h>
+
+#include <string>
+#include <algorithm>
+
+#include "EliMath.h"
+#include "GlGetError.h"
+#include "GlState.h"
+
+LightClusters::LightClusters(float lightRadius)
+{
+	constants.cellSize = lightRadius;
+	constants.lightRadius = lightRadius;
+	constants.gridMin = glm::vec3(0.0f);
+	constants.gridSize = glm::ivec3(0);
+	constants.nLights = 0;
+	constants.nBakedLights = 0;
+}
+
+void LightClusters::Build(const std::vector<glm::vec3>& lights, int nBakedLights)
+{
+	if (lights.size() > SimpleLights::maxLights)
+	{
+		std::string errorMessage = "Too many simple lights: ";
+		errorMessage.append(std::to_string(lights.size()));
+		errorMessage.append(", the maximum is ");
+		errorMessage.append(std::to_string(SimpleLights::maxLights));
+		throw std::exception(errorMessage.c_str());
+	}
+
+	//The grid only covers the space the lights can reach, fragments outside of it don't get any light
+	const float radius = constants.lightRadius;
+	EliMath::AABB bounds;
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		constants.lights[i] = glm::vec4(lights[i], 1.0f);
+		bounds.Grow(lights[i] - glm::vec3(radius));
+		bounds.Grow(lights[i] + glm::vec3(radius));
+	}
+	constants.nLights = (int)lights.size();
+	constants.nBakedLights = nBakedLights;
+	if (lights.empty())
+	{
+		constants.gridMin = glm::vec3(0.0f);
+		constants.gridSize = glm::ivec3(0);
+		texels.assign(1, glm::ivec2(0));	//Texture buffers can't be empty
+		return;
+	}
+	constants.gridMin = bounds.min;
+	constants.gridSize = glm::max(glm::ivec3(glm::ceil((bounds.max - bounds.min) / constants.cellSize)), glm::ivec3(1));
+	const glm::ivec3 gridSize = constants.gridSize;
+	const int nCells = gridSize.x * gridSize.y * gridSize.z;
+
+	//Calls visit for every cell the light's sphere touches
+	auto ForEachCell = [this, radius, gridSize](glm::vec3 light, auto visit)
+	{
+		glm::ivec3 first = glm::max(glm::ivec3(glm::floor((light - radius - constants.gridMin) / constants.cellSize)), glm::ivec3(0));
+		glm::ivec3 last = glm::min(glm::ivec3(glm::floor((light + radius - constants.gridMin) / constants.cellSize)), gridSize - 1);
+		for (int z = first.z; z <= last.z; z++)
+		{
+			for (int y = first.y; y <= last.y; y++)
+			{
+				for (int x = first.x; x <= last.x; x++)
+				{
+					glm::vec3 cellMin = constants.gridMin + glm::vec3(x, y, z) * constants.cellSize;
+					glm::vec3 closest = glm::clamp(light, cellMin, cellMin + constants.cellSize);
+					if (glm::dot(closest - light, closest - light) <= radius * radius)
+					{
+						visit(x + gridSize.x * (y + gridSize.y * z));
+					}
+				}
+			}
+		}
+	};
+
+	//Count the lights per cell first, then hand every cell its range of the index list, just like a counting sort
+	texels.assign(nCells, glm::ivec2(0));
+	for (const glm::vec3& light : lights)
+	{
+		ForEachCell(light, [this](int cell) { texels[cell].y++; });
+	}
+	int offset = nCells;
+	for (int cell = 0; cell < nCells; cell++)
+	{
+		texels[cell].x = offset;
+		offset += texels[cell].y;
+	}
+	texels.resize(offset, glm::ivec2(0));
+
+	std::vector<int> nWritten(nCells, 0);
+	for (int i = 0; i < (int)lights.size(); i++)
+	{
+		ForEachCell(lights[i], [this, &nWritten, i](int cell) { texels[texels[cell].x + nWritten[cell]++].x = i; });
+	}
+}
+
+void LightClusters::Upload()
+{
+	if (!uniformBuffer)
+	{
+		uniformBuffer = std::make_unique<UniformBuffer>(UniformBlock::SimpleLights, sizeof(SimpleLights));
+
+		glGenBuffers(1, &buffer);
+		glGenTextures(1, &texture);
+		glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::ivec2), nullptr, GL_STREAM_DRAW);
+		GlState::BindTexture(GL_TEXTURE_BUFFER, texture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32I, buffer);
+		GlState::BindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+	uniformBuffer->Update(constants);
+
+	//Orphaned every frame, the texture keeps pointing at the buffer name
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	glBufferData(GL_TEXTURE_BUFFER, texels.size() * sizeof(glm::ivec2), texels.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	GlState::ActiveTexture(textureUnit);
+	GlState::BindTexture(GL_TEXTURE_BUFFER, texture);
+	GlState::ActiveTexture(0);
+	GL_ERROR_CHECK();
+}
+
+glm::ivec3 LightClusters::GetGridSize() const
+{
+	return constants.gridSize;
+}
+
+int LightClusters::GetCellIndex(glm::vec3 pos) const
+{
+	glm::ivec3 cell = glm::ivec3(glm::floor((pos - constants.gridMin) / constants.cellSize));
+	if (glm::any(glm::lessThan(cell, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(cell, constants.gridSize)))
+	{
+		return -1;
+	}
+	return cell.x + constants.gridSize.x * (cell.y + constants.gridSize.y * cell.z);
+}
+
+std::vector<int> LightClusters::GetLightsInCell(int cellIndex) const
+{
+	std::vector<int> result;
+	const glm::ivec2 range = texels[cellIndex];
+	for (int i = range.x; i < range.x + range.y; i++)
+	{
+		result.push_back(texels[i].x);
+	}
+	return result;
+}
\ No newline at end of file
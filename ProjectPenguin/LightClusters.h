@@ -0,0 +1,37 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <vector>
+#include <memory>
+
+#include "UniformBuffer.h"
+
+//Bins point lights into a coarse grid over the lights, so a fragment only visits the lights that can reach its cell.
+//The cells are as big as the light radius, so a light touches at most 3x3x3 cells.
+//The positions go into the SimpleLights uniform block, the cells into a texture buffer:
+//first one texel per cell with the offset and count of its lights, followed by the light indices of all cells.
+class LightClusters
+{
+public:
+	LightClusters(float lightRadius);
+
+	//The first nBakedLights lights are skipped by meshes that have them in their lightmap
+	void Build(const std::vector<glm::vec3>& lights, int nBakedLights = 0);
+	//Also binds the texture buffer to its texture unit, which nothing else uses
+	void Upload();
+
+	glm::ivec3 GetGridSize() const;
+	int GetCellIndex(glm::vec3 pos) const;	//-1 when outside of the grid
+	std::vector<int> GetLightsInCell(int cellIndex) const;
+public:
+	static constexpr int textureUnit = 5;
+private:
+	SimpleLights constants;
+	std::vector<glm::ivec2> texels;
+
+	//Created on the first upload, so the grid can be built without a context
+	std::unique_ptr<UniformBuffer> uniformBuffer;
+	unsigned int buffer = 0;
+	unsigned int texture = 0;
+};
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "Lightmap.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+#include "EliMath.h"
+#include "SaveFile.h"
+#include "UIAtlas.h"
+
+std::vector<unsigned char> Lightmap::Get(const Mesh& mesh, const Unwrapped& unwrapped, const Lights& lights, std::string name, bool forceBake)
+{
+	//The cache is keyed by everything that ends up in the lightmap, so moving a light or changing a model bakes it again
+	uint64_t key = EliMath::HashBytes(mesh.positions.data(), mesh.positions.size() * sizeof(glm::vec3));
+	key = EliMath::HashBytes(mesh.normals.data(), mesh.normals.size() * sizeof(glm::vec3), key);
+	key = EliMath::HashBytes(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int), key);
+	key = EliMath::HashBytes(lights.positions.data(), lights.positions.size() * sizeof(glm::vec3), key);
+	key = EliMath::HashBytes(&lights.radius, sizeof(lights.radius), key);
+
+	std::string fileName = "Lightmap_";
+	fileName.append(name.substr(0, name.find_last_of('.')));
+	fileName.append(".bin");
+
+	std::vector<unsigned char> pixels;
+	if (!forceBake && LoadFromCache(fileName, key, pixels))
+	{
+		return pixels;
+	}
+
+	std::cout << "Baking the lightmap for " << name << std::endl;
+	pixels = Bake(mesh, unwrapped, lights);
+	SaveToCache(fileName, key, pixels);
+	return pixels;
+}
+
+Lightmap::Unwrapped Lightmap::Unwrap(const Mesh& mesh, const Lights& lights)
+{
+	const size_t nTriangles = mesh.indices.size() / 3;
+
+	//Only triangles that a light can reach need texels of their own
+	std::vector<bool> lit(nTriangles, false);
+	std::vector<float> longestEdges(nTriangles, 0.0f);
+	for (size_t t = 0; t < nTriangles; t++)
+	{
+		EliMath::AABB bounds;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			const glm::vec3 a = mesh.positions[mesh.indices[t * 3 + corner]];
+			const glm::vec3 b = mesh.positions[mesh.indices[t * 3 + (corner + 1) % 3]];
+			bounds.Grow(a);
+			longestEdges[t] = std::max(longestEdges[t], glm::distance(a, b));
+		}
+		for (const glm::vec3& light : lights.positions)
+		{
+			glm::vec3 closest = glm::clamp(light, bounds.min, bounds.max);
+			if (glm::distance(closest, light) < lights.radius)
+			{
+				lit[t] = true;
+				break;
+			}
+		}
+	}
+
+	//Cells are sized by the longest edge of their triangle, the density is lowered until everything fits
+	//The first cell is the black one that all unlit triangles share
+	std::vector<size_t> cellTriangles;
+	for (size_t t = 0; t < nTriangles; t++)
+	{
+		if (lit[t])
+		{
+			cellTriangles.push_back(t);
+		}
+	}
+	std::vector<glm::ivec2> sizes(cellTriangles.size() + 1);
+	std::vector<glm::ivec2> positions;
+	for (float texelsPerUnit = maxTexelsPerUnit; ; texelsPerUnit *= 0.8f)
+	{
+		bool smallest = true;
+		sizes[0] = glm::ivec2(minCellSize);
+		for (size_t i = 0; i < cellTriangles.size(); i++)
+		{
+			int size = (int)std::ceil(longestEdges[cellTriangles[i]] * texelsPerUnit) + padding * 2;
+			size = glm::clamp(size, minCellSize, maxCellSize);
+			smallest = smallest && size == minCellSize;
+			sizes[i + 1] = glm::ivec2(size);
+		}
+
+		int atlasHeight = 0;
+		positions = UIAtlas::PackShelves(sizes, resolution, 0, atlasHeight);
+		if (atlasHeight <= resolution)
+		{
+			break;
+		}
+		if (smallest)
+		{
+			std::stringstream errorMessage;
+			errorMessage << "A mesh with " << cellTriangles.size() << " lit triangles doesn't fit in a lightmap of " << resolution << " texels";
+			throw std::exception(errorMessage.str().c_str());
+		}
+	}
+
+	//Each triangle takes the bottom left half of its cell, the other half only holds padding
+	Unwrapped result;
+	result.cells.assign(nTriangles, glm::ivec3(positions[0] + minCellSize / 2, 0));
+	for (size_t i = 0; i < cellTriangles.size(); i++)
+	{
+		result.cells[cellTriangles[i]] = glm::ivec3(positions[i + 1], sizes[i + 1].x);
+	}
+	for (size_t t = 0; t < nTriangles; t++)
+	{
+		const glm::ivec3 cell = result.cells[t];
+		const glm::vec2 corner = glm::vec2((float)cell.x, (float)cell.y);
+		const float inner = (float)std::max(cell.z - padding * 2, 0);
+		const glm::vec2 texels[3] = {
+			corner + (cell.z > 0 ? glm::vec2((float)padding) : glm::vec2(0.0f)),
+			corner + (cell.z > 0 ? glm::vec2((float)padding + inner, (float)padding) : glm::vec2(0.0f)),
+			corner + (cell.z > 0 ? glm::vec2((float)padding, (float)padding + inner) : glm::vec2(0.0f))
+		};
+		for (int c = 0; c < 3; c++)
+		{
+			result.vertexRemap.push_back(mesh.indices[t * 3 + c]);
+			result.texcoords.push_back(texels[c] / (float)resolution);
+			result.indices.push_back((unsigned int)(t * 3 + c));
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned char> Lightmap::Bake(const Mesh& mesh, const Unwrapped& unwrapped, const Lights& lights)
+{
+	std::vector<unsigned char> pixels((size_t)resolution * (size_t)resolution, 0);
+	for (size_t t = 0; t < unwrapped.cells.size(); t++)
+	{
+		const glm::ivec3 cell = unwrapped.cells[t];
+		if (cell.z == 0)
+		{
+			continue;
+		}
+
+		const glm::vec3 p[3] = {
+			mesh.positions[mesh.indices[t * 3]], mesh.positions[mesh.indices[t * 3 + 1]], mesh.positions[mesh.indices[t * 3 + 2]] };
+		const glm::vec3 n[3] = {
+			mesh.normals[mesh.indices[t * 3]], mesh.normals[mesh.indices[t * 3 + 1]], mesh.normals[mesh.indices[t * 3 + 2]] };
+		const glm::vec3 faceNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+		const float inner = (float)(cell.z - padding * 2);
+
+		//Every texel of the cell is filled, the ones outside of the triangle get the value of the closest point on it
+		for (int y = cell.y; y < cell.y + cell.z; y++)
+		{
+			for (int x = cell.x; x < cell.x + cell.z; x++)
+			{
+				float u = std::max(((float)(x - cell.x) + 0.5f - (float)padding) / inner, 0.0f);
+				float v = std::max(((float)(y - cell.y) + 0.5f - (float)padding) / inner, 0.0f);
+				if (u + v > 1.0f)
+				{
+					float sum = u + v;
+					u /= sum;
+					v /= sum;
+				}
+
+				glm::vec3 position = p[0] * (1.0f - u - v) + p[1] * u + p[2] * v;
+				glm::vec3 normal = n[0] * (1.0f - u - v) + n[1] * u + n[2] * v;
+				normal = glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::normalize(faceNormal);
+
+				float intensity = glm::clamp(Evaluate(position, normal, lights) / maxIntensity, 0.0f, 1.0f);
+				pixels[(size_t)y * (size_t)resolution + (size_t)x] = (unsigned char)std::lround(intensity * 255.0f);
+			}
+		}
+	}
+	return pixels;
+}
+
+float Lightmap::Evaluate(glm::vec3 position, glm::vec3 normal, const Lights& lights)
+{
+	float result = 0.0f;
+	for (const glm::vec3& light : lights.positions)
+	{
+		result += glm::clamp((lights.radius - glm::distance(position, light)) / lights.radius, 0.0f, 1.0f)
+			* std::max(glm::dot(light - position, normal), 0.0f);
+	}
+	return result;
+}
+
+bool Lightmap::LoadFromCache(std::string fileName, uint64_t key, std::vector<unsigned char>& pixels)
+{
+	if (!SaveFile::FileExists(fileName))
+	{
+		return false;
+	}
+
+	std::string filePath = "UserData/";
+	filePath.append(fileName);
+	std::ifstream file(filePath, std::ios::binary);
+
+	//Header: version, key and resolution all have to match
+	uint32_t version = 0;
+	uint64_t storedKey = 0;
+	int32_t storedResolution = 0;
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+	file.read(reinterpret_cast<char*>(&storedResolution), sizeof(storedResolution));
+	if (!file || version != cacheVersion || storedKey != key || storedResolution != resolution)
+	{
+		std::cout << "Lightmap " << fileName << " is out of date" << std::endl;
+		return false;
+	}
+
+	pixels.resize((size_t)resolution * (size_t)resolution);
+	file.read(reinterpret_cast<char*>(pixels.data()), pixels.size());
+	if (!file)
+	{
+		std::cout << "Lightmap " << fileName << " is incomplete" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void Lightmap::SaveToCache(std::string fileName, uint64_t key, const std::vector<unsigned char>& pixels)
+{
+	std::string filePath = "UserData/";
+	filePath.append(fileName);
+	std::ofstream file(filePath, std::ios::binary);
+
+	uint32_t version = cacheVersion;
+	int32_t storedResolution = resolution;
+	file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+	file.write(reinterpret_cast<const char*>(&storedResolution), sizeof(storedResolution));
+	file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Bakes the light of fixed simple lights into a texture, so static geometry doesn't have to evaluate them every frame.
+//The models don't have a second set of texture coordinates, so every lit triangle gets its own cell in the lightmap
+//and all triangles that no light can reach share one black cell. Lightmaps store a single intensity per texel,
+//the shader applies the light colour. Nothing here needs a GPU, baking can be done from the command line.
+class Lightmap
+{
+public:
+	struct Mesh
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> normals;
+		std::vector<unsigned int> indices;
+	};
+	//Triangles can't share lightmap coordinates, so every corner gets its own vertex, a copy of vertexRemap[i]
+	struct Unwrapped
+	{
+		std::vector<unsigned int> vertexRemap;
+		std::vector<glm::vec2> texcoords;
+		std::vector<unsigned int> indices;
+		std::vector<glm::ivec3> cells;	//Per triangle: corner and size in texels, the size is 0 for unlit triangles
+	};
+	struct Lights
+	{
+		std::vector<glm::vec3> positions;	//In the space of the mesh
+		float radius = 3.0f;
+	};
+public:
+	//Loads the lightmap from the cache, or bakes and caches it when the mesh or lights have changed
+	static std::vector<unsigned char> Get(const Mesh& mesh, const Unwrapped& unwrapped, const Lights& lights, std::string name, bool forceBake = false);
+
+	static Unwrapped Unwrap(const Mesh& mesh, const Lights& lights);
+	static std::vector<unsigned char> Bake(const Mesh& mesh, const Unwrapped& unwrapped, const Lights& lights);
+	//Same falloff as the simple lights in Surroundings.frag
+	static float Evaluate(glm::vec3 position, glm::vec3 normal, const Lights& lights);
+private:
+	static bool LoadFromCache(std::string fileName, uint64_t key, std::vector<unsigned char>& pixels);
+	static void SaveToCache(std::string fileName, uint64_t key, const std::vector<unsigned char>& pixels);
+public:
+	static constexpr int resolution = 1024;
+	static constexpr float maxIntensity = 2.0f;	//Texels store a fraction of this, has to match Surroundings.frag
+private:
+	static constexpr uint32_t cacheVersion = 1;	//Increase whenever the output of the baker changes
+	static constexpr int padding = 1;	//Texels around each triangle, so linear filtering doesn't pick up the neighbours
+	static constexpr int minCellSize = 4;
+	static constexpr int maxCellSize = 64;
+	static constexpr float maxTexelsPerUnit = 16.0f;	//Lowered until every cell fits
+};
\ No newline at end of file
@@ -1,9 +1,34 @@
 #include <Windows.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
 #include "Window.h"
 #include "Game.h"
+#include "IceRink.h"
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR pCmdLine, int nCmdShow)
 {
+	//"ProjectPenguin.exe -bakelightmaps" only bakes the lightmaps, without opening a window
+	if (std::strstr(pCmdLine, "-bakelightmaps") != nullptr)
+	{
+		//Print to the console that started the game
+		FILE* console = nullptr;
+		if (AttachConsole(ATTACH_PARENT_PROCESS))
+		{
+			freopen_s(&console, "CONOUT$", "w", stdout);
+		}
+		try
+		{
+			IceRink::BakeLightmaps();
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
 	try
 	{
 		Window window(1920, 1080, "Dance of the Penguins");
@@ -5,124 +5,105 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <limits>
+#include <cstddef>
 
 #include "Camera.h"
-#include "Light.h"
+#include "GLTFData.h"
 #include "GlGetError.h"
+#include "GlState.h"
+#include "GlCapabilities.h"
 
 //Static members
 std::unordered_map<std::string, Model::ModelData> Model::existingModels;
+GeometryArena Model::geometryArena;
+std::vector<unsigned int> Model::sharedVaos;
+std::vector<Model::InstanceData> Model::shadowCasters;
+const Shader* Model::depthPrepassShader = nullptr;
 
-Model::Model(std::string name, const glm::mat4& ownerTransform, std::string vertexShader, std::string fragShader)
+Model::Model(std::string name, const glm::mat4& ownerTransform, std::string vertexShader, std::string fragShader, std::string defines)
 	:
 	ownerTransform(ownerTransform),
-	modelData(ConstructModelData(name, vertexShader, fragShader))
+	modelData(ConstructModelData(name, vertexShader, fragShader, defines))
 {
 	glm::vec3 printPos = glm::vec3(ownerTransform[3]);
 	std::cout << "Created model " << '\"' << name << '\"' << " at " << "(" << printPos.x << ", " << printPos.y << ", " << printPos.z << ")" << std::endl;
 }
 
-void Model::Preload(std::string name, std::string vertexShader, std::string fragShader)
+void Model::Preload(std::string name, std::string vertexShader, std::string fragShader, std::string defines)
 {
-	ConstructModelData(name, vertexShader, fragShader);
+	ConstructModelData(name, vertexShader, fragShader, defines);
 }
 
 void Model::AddToRenderQueue(Camera& camera)
 {
-	//Add model transform and MVP to renderqueue
-	modelData.renderQueue.push_back(std::make_pair(ownerTransform, camera.GetVPMatrix() * ownerTransform));
+	//Add model transform to renderqueue, the MVP is calculated on the GPU
+	if (camera.IsInView(EliMath::TransformSphere(modelData.boundingSphere, ownerTransform)))
+	{
+		modelData.renderQueue.push_back({ ownerTransform, Light::allFaces, modelData.texture.layer });
+	}
+	else
+	{
+		modelData.culledQueue.push_back({ ownerTransform, Light::allFaces, modelData.texture.layer });
+	}
 }
 
-void Model::DrawAllInstances(const Light& light)
+void Model::SubmitInstances(RenderQueue& renderQueue, StreamBuffer& streamBuffer)
 {
 	for (std::pair<const std::string, ModelData>& element : existingModels)
 	{
 		ModelData& model = element.second;
-		
-		//Bind shader
-		model.shader->Use();
-		
-		GL_ERROR_CHECK();
-
-		//Bind texture
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, model.texture);
-		model.shader->SetUniformInt("tex", 0);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, light.GetShadowCubeMap());
-		model.shader->SetUniformInt("shadowCubeMap", 1);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, light.GetBakedShadowCubeMap());
-		model.shader->SetUniformInt("shadowCubeMapBaked", 2);
-
-		GL_ERROR_CHECK();
 
-		//Bind vao
-		glBindVertexArray(model.vao);
-
-		GL_ERROR_CHECK()
-
-		//Draw instances
-		for (auto& instance : model.renderQueue)
+		//Models that aren't drawn this frame don't cost anything
+		if (!model.renderQueue.empty())
 		{
-			const auto modelTransform = instance.first;
-			const auto transform = instance.second;
-
-			model.shader->SetUniformMat4("model", modelTransform);
-			model.shader->SetUniformMat4("mvp", transform);
-			model.shader->SetUniformFloat("lightFarPlane", light.GetFarPlane());
-			model.shader->SetUniformVec3("lightPos", light.GetPos());
-
-			GL_ERROR_CHECK()
-
-			glDrawElements(GL_TRIANGLES, (GLsizei)model.nIndices, GL_UNSIGNED_SHORT, 0);
-			
-			GL_ERROR_CHECK()
+			DrawOptions options;
+			options.textureArray = true;
+			unsigned int vao = UploadInstances(model, model.renderQueue, streamBuffer, options);
+			renderQueue.SubmitOpaque(*model.shader, *depthPrepassShader, model.texture.textureArray, vao, model.mesh.nIndices, model.renderQueue.size(),
+				GetNearestInstanceDistance(model, renderQueue.GetViewPos()), options);
 		}
 
-		//Unbind vao
-		glBindVertexArray(0);
-
 		//Clear renderqueue
 		model.renderQueue.clear();
-
-		GL_ERROR_CHECK()
+		model.culledQueue.clear();
 	}
+	GL_ERROR_CHECK();
 }
 
-void Model::DrawShadows(const Light& light)
+void Model::SubmitShadowCasters(RenderQueue& renderQueue, Light& light, StreamBuffer& streamBuffer)
 {
 	for (std::pair<const std::string, ModelData>& element : existingModels)
 	{
 		ModelData& model = element.second;
 
-		//Bind vao
-		glBindVertexArray(model.vao);
-
-		GL_ERROR_CHECK();
-
-		//Draw instances
-		for (auto& instance : model.renderQueue)
+		//Instances outside of the view can still cast shadows into it, only the faces of the shadow cube map matter here
+		uint64_t modelHash = EliMath::HashBytes(element.first.data(), element.first.size(), model.geometryHash);
+		shadowCasters.clear();
+		for (const std::vector<InstanceData>* queue : { &model.renderQueue, &model.culledQueue })
 		{
-			const auto modelTransform = instance.first;
-
-			light.GetNonAnimationShader().SetUniformMat4("modelTransform", modelTransform);
-			light.GetNonAnimationShader().SetUniformMat4Array("shadowMatrices", light.GetShadowMatrices());
-			light.GetNonAnimationShader().SetUniformVec3("lightPos", light.GetPos());
-			light.GetNonAnimationShader().SetUniformFloat("farPlane", light.GetFarPlane());
-
-			GL_ERROR_CHECK();
-
-			glDrawElements(GL_TRIANGLES, (GLsizei)model.nIndices, GL_UNSIGNED_SHORT, 0);
-
-			GL_ERROR_CHECK();
+			for (const InstanceData& instance : *queue)
+			{
+				int faceMask = light.GetFaceMask(EliMath::TransformSphere(model.boundingSphere, instance.modelTransform));
+				if (faceMask != 0)
+				{
+					shadowCasters.push_back({ instance.modelTransform, faceMask });
+					light.AddShadowCaster(faceMask, EliMath::HashBytes(&instance.modelTransform, sizeof(glm::mat4), modelHash));
+				}
+			}
+		}
+		if (shadowCasters.empty())
+		{
+			continue;
 		}
 
-		//Unbind vao
-		glBindVertexArray(0);
-
-		GL_ERROR_CHECK()
+		//The queues are kept, the visible instances are drawn again in the colour pass
+		DrawOptions options;
+		unsigned int vao = UploadInstances(model, shadowCasters, streamBuffer, options);
+		renderQueue.Submit(RenderPass::Shadow, light.GetNonAnimationShader(), 0, vao, model.mesh.nIndices, shadowCasters.size(), 0.0f, options);
 	}
+	GL_ERROR_CHECK();
 }
 
 const Shader& Model::GetShader() const
@@ -130,7 +111,7 @@ const Shader& Model::GetShader() const
 	return *modelData.shader;
 }
 
-Model::ModelData& Model::ConstructModelData(std::string name, std::string vertexShader, std::string fragShader)
+Model::ModelData& Model::ConstructModelData(std::string name, std::string vertexShader, std::string fragShader, std::string defines)
 {
 	//Check if model has been previously loaded
 	//WARNING: THIS MAKES IT SO THAT ALL INSTANCES OF THE SAME MODEL USE THE SAME SHADER!
@@ -140,7 +121,24 @@ Model::ModelData& Model::ConstructModelData(std::string name, std::string vertex
 		auto& newModelData = existingModels[name];
 
 		//-------------------------Step 1: Make the shader-------------------------------------------------
-		newModelData.shader = std::make_unique<Shader>(vertexShader, fragShader);
+		//Textures come from the texture array pool, the same key as static batches use means programs are shared with them
+		std::string arrayDefines = TextureArrayPool::defines;
+		if (!defines.empty())
+		{
+			arrayDefines.append(";");
+			arrayDefines.append(defines);
+		}
+		newModelData.shader = &Shader::GetShared(vertexShader, fragShader, "", arrayDefines);
+
+		//Texture units never change, so samplers only need to be set once per program
+		newModelData.shader->Use();
+		newModelData.shader->SetUniformInt("tex", 0);
+		newModelData.shader->SetUniformInt("shadowCubeMap", 1);
+
+		if (!depthPrepassShader)
+		{
+			depthPrepassShader = &Shader::GetShared("DepthPrepass.vert", "DepthPrepass.frag");
+		}
 
 		//-------------------------Step 2: Load the model using tinyGLTF-------------------------------------------------
 		//Import the model and check errors
@@ -183,95 +181,20 @@ Model::ModelData& Model::ConstructModelData(std::string name, std::string vertex
 		GL_ERROR_CHECK()
 
 
-		//-------------------------Step 4: Set up vao,vbo,ebo and set up vertex attrib pointers-------------------------------------------------
-		//Generate VAO, VBO and EBO
-		glGenVertexArrays(1, &newModelData.vao);
-		glBindVertexArray(newModelData.vao);
-
-		unsigned int ebo;
-		glGenBuffers(1, &ebo);
-
-		//Rettrieve attribute data and fill VBO, set up
-		std::map<int, unsigned int> vbos;
-		for (int i = 0; i < data.bufferViews.size(); ++i)
+		//-------------------------Step 4: Copy the geometry into the arena and set up the vao-------------------------------------------------
+		//Every model is converted to the vertex format of the arena, so they can share its buffers
+		if (primitiveData.attributes.count("POSITION") == 0 || primitiveData.attributes.count("NORMAL") == 0)
 		{
-			const tinygltf::BufferView& bufferView = data.bufferViews[i];
-			if (bufferView.target == 0)
-			{  // TODO impl drawarrays
-				std::cout << "WARN: bufferView.target is zero" << std::endl;
-				continue;
-			}
-
-			const tinygltf::Buffer& buffer = data.buffers[bufferView.buffer];
-			std::cout << "bufferview.target " << bufferView.target << std::endl;
-
-			GLuint vbo;
-			glGenBuffers(1, &vbo);
-			vbos[i] = vbo;
-			glBindBuffer(bufferView.target, vbo);
-
-			std::cout << "buffer.data.size = " << buffer.data.size()
-				<< ", bufferview.byteOffset = " << bufferView.byteOffset
-				<< std::endl;
-
-			glBufferData(bufferView.target, bufferView.byteLength,
-				&buffer.data.at(0) + bufferView.byteOffset, GL_STATIC_DRAW);
-		}
-
-		//std::vector<unsigned int> vbos;
-
-		/*
-		for (auto& attrib : primitiveData.attributes)
-		{
-			const tinygltf::Accessor& attribAccessor = data.accessors[attrib.second];
-			const tinygltf::BufferView& attribBufferView = data.bufferViews[attribAccessor.bufferView];
-			std::cout << "bufferView.target " << attribBufferView.target << std::endl;
-
-			const tinygltf::Buffer& attribBuffer = data.buffers[attribBufferView.buffer];
-			GLuint temp;
-			glGenBuffers(1, &temp);
-			glBindBuffer(GL_ARRAY_BUFFER, temp);
-			glBufferData(GL_ARRAY_BUFFER, attribBufferView.byteLength, &attribBuffer.data.at(0) + attribBufferView.byteOffset, GL_STATIC_DRAW);
-			vbos.push_back(temp);
+			std::string errorMessage;
+			errorMessage.append("The model \"");
+			errorMessage.append(name);
+			errorMessage.append("\" could not be loaded, it needs positions and normals");
+			throw std::exception(errorMessage.c_str());
 		}
-		*/
-
-		//Retrieve index data and fill EBO and save nIndices
-		const tinygltf::Accessor& indexAccessor = data.accessors[primitiveData.indices];
-		const tinygltf::BufferView& indexBufferView = data.bufferViews[indexAccessor.bufferView];
-		const tinygltf::Buffer& indexBuffer = data.buffers[indexBufferView.buffer];
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferView.byteLength, &indexBuffer.data.at(0) + indexBufferView.byteOffset, GL_STATIC_DRAW);
-		newModelData.nIndices = indexAccessor.count;
-
-		//Set up vertex attrib pointers
 		for (auto& attrib : primitiveData.attributes)
 		{
 			const tinygltf::Accessor& accessor = data.accessors[attrib.second];
-			int byteStride = accessor.ByteStride(data.bufferViews[accessor.bufferView]);
-			glBindBuffer(GL_ARRAY_BUFFER, vbos[accessor.bufferView]);
-
-			int size = 1;
-			if (accessor.type != TINYGLTF_TYPE_SCALAR)
-			{
-				size = accessor.type;
-			}
-
-			int vertexPointer = -1;
-			if (attrib.first.compare("POSITION") == 0) vertexPointer = 0;
-			if (attrib.first.compare("NORMAL") == 0) vertexPointer = 1;
-			if (attrib.first.compare("TEXCOORD_0") == 0) vertexPointer = 2;
-			if (vertexPointer > -1)
-			{
-				glVertexAttribPointer(vertexPointer,
-					size,
-					accessor.componentType,
-					accessor.normalized ? GL_TRUE : GL_FALSE,
-					byteStride,
-					(char*)0 + accessor.byteOffset);
-				glEnableVertexAttribArray(vertexPointer);
-			}
-			else
+			if (attrib.first.compare("POSITION") != 0 && attrib.first.compare("NORMAL") != 0 && attrib.first.compare("TEXCOORD_0") != 0)
 			{
 				std::string errorMessage;
 				errorMessage.append("The model \"");
@@ -280,11 +203,85 @@ Model::ModelData& Model::ConstructModelData(std::string name, std::string vertex
 				errorMessage.append(attrib.first);
 				throw std::exception(errorMessage.c_str());
 			}
+			if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+			{
+				std::string errorMessage;
+				errorMessage.append("The model \"");
+				errorMessage.append(name);
+				errorMessage.append("\" could not be loaded, only float vertex attributes are supported");
+				throw std::exception(errorMessage.c_str());
+			}
 		}
-		GL_ERROR_CHECK();
 
+		tinygltf::Accessor& positionAccessor = data.accessors[primitiveData.attributes.at("POSITION")];
+		GLTFData positions(data, positionAccessor);
+		GLTFData normals(data, data.accessors[primitiveData.attributes.at("NORMAL")]);
+		//Models without texture coordinates get a single texel of their texture
+		const bool hasTexcoords = primitiveData.attributes.count("TEXCOORD_0") != 0;
+		std::unique_ptr<GLTFData> texcoords;
+		if (hasTexcoords)
+		{
+			texcoords = std::make_unique<GLTFData>(data, data.accessors[primitiveData.attributes.at("TEXCOORD_0")]);
+		}
+
+		std::vector<GeometryArena::Vertex> vertices(positionAccessor.count);
+		for (size_t i = 0; i < positionAccessor.count; i++)
+		{
+			vertices[i].position = *positions.GetElement<glm::vec3>(i);
+			vertices[i].normal = *normals.GetElement<glm::vec3>(i);
+			vertices[i].texcoord = hasTexcoords ? *texcoords->GetElement<glm::vec2>(i) : glm::vec2(0.0f);
+		}
+
+		//glTF requires min and max on POSITION accessors, which makes for free bounding volumes
+		if (positionAccessor.minValues.size() == 3 && positionAccessor.maxValues.size() == 3)
+		{
+			newModelData.bounds.Grow(glm::vec3(positionAccessor.minValues[0], positionAccessor.minValues[1], positionAccessor.minValues[2]));
+			newModelData.bounds.Grow(glm::vec3(positionAccessor.maxValues[0], positionAccessor.maxValues[1], positionAccessor.maxValues[2]));
+		}
+		newModelData.boundingSphere = EliMath::SphereFromAABB(newModelData.bounds);
+
+		//Indices are widened to 32 bits, the arena only has one index format
+		tinygltf::Accessor& indexAccessor = data.accessors[primitiveData.indices];
+		GLTFData indexData(data, indexAccessor);
+		std::vector<unsigned int> indices(indexAccessor.count);
+		for (size_t i = 0; i < indexAccessor.count; i++)
+		{
+			switch (indexAccessor.componentType)
+			{
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+				indices[i] = *indexData.GetElement<unsigned char>(i);
+				break;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+				indices[i] = *indexData.GetElement<unsigned short>(i);
+				break;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+				indices[i] = *indexData.GetElement<unsigned int>(i);
+				break;
+			}
+		}
+		newModelData.mesh = geometryArena.Add(vertices, indices);
+		newModelData.geometryHash = EliMath::HashBytes(vertices.data(), vertices.size() * sizeof(GeometryArena::Vertex));
+		newModelData.geometryHash = EliMath::HashBytes(indices.data(), indices.size() * sizeof(unsigned int), newModelData.geometryHash);
+
+		//Own vao for drawing without multi draw indirect, it uses the arena's buffers but points its instance attributes at its own uploads
+		glGenVertexArrays(1, &newModelData.vao);
+		GlState::BindVertexArray(newModelData.vao);
+		geometryArena.SetUpVertexAttributes(newModelData.mesh.block);
+
+		//Set up per instance model matrix, the attributes are pointed at the stream buffer whenever the render queue is uploaded
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			glEnableVertexAttribArray(instanceAttribLocation + i);
+			glVertexAttribDivisor(instanceAttribLocation + i, 1);
+		}
+		glEnableVertexAttribArray(faceMaskAttribLocation);
+		glVertexAttribDivisor(faceMaskAttribLocation, 1);
+		glEnableVertexAttribArray(layerAttribLocation);
+		glVertexAttribDivisor(layerAttribLocation, 1);
+		GlState::BindVertexArray(0);
+		GL_ERROR_CHECK();
 
-		//-------------------------Step 4: Set up the texture-------------------------------------------------
+		//-------------------------Step 5: Set up the texture-------------------------------------------------
 		//Gain access to the gltf data
 		if (data.materials.empty())
 		{
@@ -306,59 +303,94 @@ Model::ModelData& Model::ConstructModelData(std::string name, std::string vertex
 		tinygltf::Texture& textureData = data.textures[material.pbrMetallicRoughness.baseColorTexture.index];
 		tinygltf::Image& image = data.images[textureData.source];
 
-		//Figure out format
-		GLenum format;
-		switch (image.component)
-		{
-		case 1:
-			format = GL_RED;
-			break;
-		case 2:
-			format = GL_RG;
-			break;
-		case 3:
-			format = GL_RGB;
-			break;
-		case 4:
-			format = GL_RGBA;
-			break;
-		default:
-			std::string errorMessage;
-			errorMessage.append("The texture for ");
-			errorMessage.append(name);
-			errorMessage.append(" could not be loaded, because it had an unsupported format: ");
-			errorMessage.append(std::to_string(image.component));
-			errorMessage.append(" components");
-			throw std::exception(errorMessage.c_str());
-		}
+		//Add the texture to the pool, the layer is passed along with every instance
+		newModelData.texture = TextureArrayPool::Add(image, name, TextureArrayPool::UsesEmissiveKeys(fragShader));
+	}
 
-		//Figure out the type
-		GLenum type;
-		switch (image.bits)
-		{
-		case 8:
-			type = GL_UNSIGNED_BYTE;
-			break;
-		case 16:
-			type = GL_UNSIGNED_SHORT;
-			break;
-		}
+	return existingModels.at(name);
+}
 
-		//Generate texture
-		glGenTextures(1, &newModelData.texture);
-		glBindTexture(GL_TEXTURE_2D, newModelData.texture);
+float Model::GetNearestInstanceDistance(const ModelData& model, glm::vec3 viewPos)
+{
+	float nearest = std::numeric_limits<float>::max();
+	for (const InstanceData& instance : model.renderQueue)
+	{
+		nearest = std::min(nearest, glm::distance(viewPos, glm::vec3(instance.modelTransform[3])));
+	}
+	return nearest;
+}
 
-		//Set texture settings
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+unsigned int Model::UploadInstances(const ModelData& model, const std::vector<InstanceData>& instances, StreamBuffer& streamBuffer,
+	DrawOptions& options)
+{
+	options.uintIndices = true;
+	options.firstIndex = model.mesh.firstIndex;
+	options.baseVertex = model.mesh.baseVertex;
 
-		//Load data into texture (REPLACE: might want to use GL_RGBA instead of GL_RGB to support transparent textures, or vice versa to save space)
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, format, type, &image.image.at(0));
+	//With base instance the instances are found through the draw command, the shared vao never changes
+	if (GlCapabilities::HasMultiDrawIndirect())
+	{
+		StreamBuffer::Range range = streamBuffer.Upload(instances.data(), instances.size() * sizeof(InstanceData), sizeof(InstanceData));
+		options.baseInstance = (unsigned int)(range.offset / sizeof(InstanceData));
+		return GetSharedVao(model.mesh.block, streamBuffer);
+	}
 
-		GL_ERROR_CHECK()
+	StreamBuffer::Range range = streamBuffer.Upload(instances.data(), instances.size() * sizeof(InstanceData));
+
+	//The vao keeps pointing at this range until the next upload, which only happens after the pass has been executed
+	GlState::BindVertexArray(model.vao);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.GetBuffer());
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(instanceAttribLocation + i,
+			4,
+			GL_FLOAT,
+			GL_FALSE,
+			sizeof(InstanceData),
+			(char*)0 + range.offset + i * sizeof(glm::vec4));
 	}
+	glVertexAttribIPointer(faceMaskAttribLocation,
+		1,
+		GL_INT,
+		sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, faceMask));
+	glVertexAttribPointer(layerAttribLocation,
+		1,
+		GL_FLOAT,
+		GL_FALSE,
+		sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, layer));
+	GlState::BindVertexArray(0);
+	return model.vao;
+}
 
-	return existingModels.at(name);
+unsigned int Model::GetSharedVao(size_t block, const StreamBuffer& streamBuffer)
+{
+	while (sharedVaos.size() <= block)
+	{
+		unsigned int vao;
+		glGenVertexArrays(1, &vao);
+		GlState::BindVertexArray(vao);
+		geometryArena.SetUpVertexAttributes(sharedVaos.size());
+
+		//The stream buffer keeps its name when it's orphaned, so these pointers stay valid
+		glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.GetBuffer());
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			glVertexAttribPointer(instanceAttribLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (char*)0 + i * sizeof(glm::vec4));
+			glEnableVertexAttribArray(instanceAttribLocation + i);
+			glVertexAttribDivisor(instanceAttribLocation + i, 1);
+		}
+		glVertexAttribIPointer(faceMaskAttribLocation, 1, GL_INT, sizeof(InstanceData), (void*)offsetof(InstanceData, faceMask));
+		glEnableVertexAttribArray(faceMaskAttribLocation);
+		glVertexAttribDivisor(faceMaskAttribLocation, 1);
+		glVertexAttribPointer(layerAttribLocation, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, layer));
+		glEnableVertexAttribArray(layerAttribLocation);
+		glVertexAttribDivisor(layerAttribLocation, 1);
+		GlState::BindVertexArray(0);
+		GL_ERROR_CHECK();
+
+		sharedVaos.push_back(vao);
+	}
+	return sharedVaos[block];
 }
\ No newline at end of file
@@ -8,9 +8,14 @@
 #include <unordered_map>
 
 #include "Shader.h"
+#include "RenderQueue.h"
+#include "EliMath.h"
+#include "Light.h"
+#include "StreamBuffer.h"
+#include "GeometryArena.h"
+#include "TextureArrayPool.h"
 
 class Camera;
-class Light;
 
 /*WARNING: This class will leak memory, but due to the predictable nature of the gameplay,
 it does not make a difference whether I implement a destructor.*/
@@ -20,45 +25,74 @@ it does not make a difference whether I implement a destructor.*/
 class Model
 {
 private:
+	struct InstanceData
+	{
+		glm::mat4 modelTransform;
+		int faceMask = Light::allFaces;	//Shadow cube map faces this instance is drawn to, only used by the shadow pass
+		float layer = 0.0f;	//Layer of the model's texture array
+	};
 	struct ModelData
 	{
-		//Geometry
+		//Geometry, lives in the geometry arena. The vao is only used when multi draw indirect isn't supported
 		unsigned int vao = 0;
-		//std::map<int, unsigned int> vbos;
-		//unsigned int ebo = 0;
-		size_t nIndices = 0;
+		GeometryArena::Mesh mesh;
+		uint64_t geometryHash = 0;	//Hash of the vertices and indices, so baked shadows notice when the model file changes
 
-		//Shader
-		std::unique_ptr<Shader> shader;
+		//Shader, shared with all other models that use the same shader files
+		const Shader* shader = nullptr;
 
-		//Texture
-		unsigned int texture = 0;	//only supports models with single textures for now
+		//Base colour texture, models with textures of the same size share a texture array
+		TextureArrayPool::Layer texture;	//only supports models with single textures for now
 
-		//Queue of transforms (Model and MVP) for all instances of this model
-		std::vector<std::pair<glm::mat4, glm::mat4>> renderQueue;
+		//Bounds in model space, taken from the min and max of the POSITION accessor
+		EliMath::AABB bounds;
+		EliMath::BoundingSphere boundingSphere;
+
+		//Queue of model transforms for all instances of this model
+		std::vector<InstanceData> renderQueue;
+		//Instances outside of the view frustum, these can still cast shadows into it
+		std::vector<InstanceData> culledQueue;
 	};
 public:
 	Model(std::string name,
 		const glm::mat4& ownerTransform,
-		std::string vertexShader = "CelShader.vert",
-		std::string fragShader = "CelShader.frag");
+		std::string vertexShader = "CelShaderInstanced.vert",
+		std::string fragShader = "CelShader.frag",
+		std::string defines = "");
 
 	static void Preload(std::string name,
-		std::string vertexShader = "CelShader.vert",
-		std::string fragShader = "CelShader.frag");
+		std::string vertexShader = "CelShaderInstanced.vert",
+		std::string fragShader = "CelShader.frag",
+		std::string defines = "");
 
 	void AddToRenderQueue(Camera& camera);
-	static void DrawAllInstances(const Light& light);
-	static void DrawShadows(const Light& light);
+	static void SubmitInstances(RenderQueue& renderQueue, StreamBuffer& streamBuffer);
+	static void SubmitShadowCasters(RenderQueue& renderQueue, Light& light, StreamBuffer& streamBuffer);
 
 	const Shader& GetShader() const;
 private:
-	static ModelData& ConstructModelData(std::string name, std::string vertexShader, std::string fragShader);
+	static ModelData& ConstructModelData(std::string name, std::string vertexShader, std::string fragShader, std::string defines);
+	//Returns the vao to draw with and fills in the draw options that locate the mesh and its instances
+	static unsigned int UploadInstances(const ModelData& model, const std::vector<InstanceData>& instances, StreamBuffer& streamBuffer,
+		DrawOptions& options);
+	static unsigned int GetSharedVao(size_t block, const StreamBuffer& streamBuffer);
+	static float GetNearestInstanceDistance(const ModelData& model, glm::vec3 viewPos);
 private:
+	//The model matrix of each instance occupies 4 attribute locations (one per column), starting here
+	static constexpr unsigned int instanceAttribLocation = 5;
+	static constexpr unsigned int layerAttribLocation = 3;	//Same location as the per vertex layer of static batches
+	static constexpr unsigned int faceMaskAttribLocation = 10;
+
 	//Reference to owner transform
 	const glm::mat4& ownerTransform;
 
 	//Data for instancing
 	static std::unordered_map<std::string, ModelData> existingModels;
+	static GeometryArena geometryArena;
+	//One vao per arena block, shared by all models in it. The instance attributes point at the start of the stream buffer
+	//and draws pick their instances with a base instance, so models in the same block can be drawn in one multi draw
+	static std::vector<unsigned int> sharedVaos;
+	static std::vector<InstanceData> shadowCasters;	//Scratch space, reused every frame
+	static const Shader* depthPrepassShader;	//Shared by all models, they only differ in their fragment shaders
 	ModelData& modelData;
 };
\ No newline at end of file
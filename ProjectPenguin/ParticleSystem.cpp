@@ -0,0 +1,211 @@
+#include "ParticleSystem.h"
+
+#include <glad/glad.h>
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include "GlGetError.h"
+#include "GlState.h"
+
+//Static members
+bool ParticleSystem::graphicsInitialised = false;
+unsigned int ParticleSystem::vao = 0;
+unsigned int ParticleSystem::vbo = 0;
+unsigned int ParticleSystem::ebo = 0;
+std::unique_ptr<Shader> ParticleSystem::shader;
+UniformHandle ParticleSystem::timeHandle;
+
+ParticleSystem::ParticleSystem(ParticleType type, std::string texturePath, size_t capacity)
+	:
+	type(type),
+	lifeTime(GetLifeTime(type)),
+	particles(capacity)
+{
+	assert(capacity > 0);
+	if (!graphicsInitialised)
+	{
+		InitGraphics();
+	}
+	texture = LoadTexture(texturePath);
+}
+
+void ParticleSystem::Spawn(glm::vec3 pos)
+{
+	if (nAlive == particles.size())
+	{
+		first = (first + 1) % particles.size();
+		nAlive--;
+	}
+	particles[(first + nAlive) % particles.size()] = { pos, time, (int)type };
+	nAlive++;
+}
+
+void ParticleSystem::Update(float deltaTime)
+{
+	time += deltaTime;
+
+	//The oldest particles are at the front
+	while (nAlive > 0 && time - particles[first].spawnTime >= lifeTime)
+	{
+		first = (first + 1) % particles.size();
+		nAlive--;
+	}
+	if (nAlive == 0)
+	{
+		first = 0;
+		time = 0.0f;
+	}
+}
+
+void ParticleSystem::Draw(StreamBuffer& streamBuffer)
+{
+	if (nAlive == 0)
+	{
+		return;
+	}
+
+	//Upload in age order, the ring may wrap around so it takes up to two copies
+	StreamBuffer::Range range = streamBuffer.Allocate(nAlive * sizeof(InstanceData), sizeof(InstanceData));
+	const size_t nFirstPart = std::min(nAlive, particles.size() - first);
+	StreamBuffer::Range firstPart = { range.offset, nFirstPart * sizeof(InstanceData) };
+	streamBuffer.Write(firstPart, &particles[first]);
+	if (nFirstPart < nAlive)
+	{
+		StreamBuffer::Range secondPart = { range.offset + firstPart.size, (nAlive - nFirstPart) * sizeof(InstanceData) };
+		streamBuffer.Write(secondPart, &particles[0]);
+	}
+
+	shader->Use();
+	shader->Set(timeHandle, time);
+	GlState::ActiveTexture(0);
+	GlState::BindTexture(GL_TEXTURE_2D, texture);
+
+	//Point the per instance attributes at this frame's data
+	GlState::BindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.GetBuffer());
+	glVertexAttribPointer(spawnPositionAttribLocation, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, spawnPosition));
+	glVertexAttribPointer(spawnTimeAttribLocation, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, spawnTime));
+	glVertexAttribIPointer(typeAttribLocation, 1, GL_INT, sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, type));
+
+	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)nAlive);
+	GlState::BindVertexArray(0);
+	GL_ERROR_CHECK();
+}
+
+void ParticleSystem::Clear()
+{
+	first = 0;
+	nAlive = 0;
+	time = 0.0f;
+}
+
+size_t ParticleSystem::GetNumAlive() const
+{
+	return nAlive;
+}
+
+float ParticleSystem::GetLifeTime(ParticleType type)
+{
+	switch (type)
+	{
+	case ParticleType::Smoke:
+		return smokeTimePerFrame * (float)smokeFrames;
+	case ParticleType::Plus5:
+		return plus5LifeTime;
+	}
+	return 0.0f;
+}
+
+void ParticleSystem::InitGraphics()
+{
+	graphicsInitialised = true;
+
+	shader = std::make_unique<Shader>("Particle.vert", "Particle.frag");
+	timeHandle = shader->GetUniformHandle("time");
+	shader->Use();
+	shader->SetUniformInt("texture0", 0);
+
+	//The corners are scaled and oriented in the vertex shader
+	float vertices[] = {
+		1.0f, 1.0f,		1.0f, 1.0f,		//Top right
+		1.0f, -1.0f,	1.0f, 0.0f,		//Bottom right
+		-1.0f, -1.0f,	0.0f, 0.0f,		//Bottom left
+		-1.0f, 1.0f,	0.0f, 1.0f		//Top left
+	};
+	unsigned int indices[] = {
+		3, 1, 0,   // first triangle
+		3, 2, 1    // second triangle
+	};
+
+	//Generate VAO
+	glGenVertexArrays(1, &vao);
+	GlState::BindVertexArray(vao);
+
+	//Generate VBO
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	//Generate EBO
+	glGenBuffers(1, &ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+	//Set up attributes
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	//Per instance attributes, they're pointed at the stream buffer when drawing
+	glEnableVertexAttribArray(spawnPositionAttribLocation);
+	glVertexAttribDivisor(spawnPositionAttribLocation, 1);
+	glEnableVertexAttribArray(spawnTimeAttribLocation);
+	glVertexAttribDivisor(spawnTimeAttribLocation, 1);
+	glEnableVertexAttribArray(typeAttribLocation);
+	glVertexAttribDivisor(typeAttribLocation, 1);
+
+	GlState::BindVertexArray(0);
+	GL_ERROR_CHECK();
+}
+
+unsigned int ParticleSystem::LoadTexture(const std::string& path)
+{
+	unsigned int newTexture;
+	glGenTextures(1, &newTexture);
+	GlState::BindTexture(GL_TEXTURE_2D, newTexture);
+
+	//Set texture settings
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	//Load image data into texture
+	int width, height, nrChannels;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
+	if (data)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		std::string errorMessage = "The particle texture ";
+		errorMessage.append(path);
+		errorMessage.append(" could not be loaded");
+		throw std::exception(errorMessage.c_str());
+	}
+	stbi_set_flip_vertically_on_load(false);
+	stbi_image_free(data);
+	GlState::BindTexture(GL_TEXTURE_2D, 0);
+
+	return newTexture;
+}
\ No newline at end of file
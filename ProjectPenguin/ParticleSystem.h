@@ -0,0 +1,73 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "Shader.h"
+#include "StreamBuffer.h"
+
+#include <memory>
+#include <vector>
+#include <string>
+
+//Kinds of particles, each has its own movement and flipbook in Particle.vert
+enum class ParticleType : int
+{
+	Smoke = 0,
+	Plus5
+};
+
+//Fixed size pool of one kind of particle, all of them are drawn with a single instanced draw call.
+//Particles in a pool live equally long, so they expire in the order they spawned and the pool is a ring buffer.
+//Only the spawn position and time are stored, facing the camera, movement and flipbook frames are worked out in the vertex shader.
+class ParticleSystem
+{
+private:
+	struct InstanceData
+	{
+		glm::vec3 spawnPosition;
+		float spawnTime;
+		int type;
+	};
+public:
+	ParticleSystem(ParticleType type, std::string texturePath, size_t capacity);
+	ParticleSystem(const ParticleSystem&) = delete;
+	ParticleSystem operator=(const ParticleSystem&) = delete;
+
+	void Spawn(glm::vec3 pos);	//Replaces the oldest particle when the pool is full
+	void Update(float deltaTime);
+	void Draw(StreamBuffer& streamBuffer);	//Uses the FrameConstants uniform block of the current frame
+	void Clear();
+
+	size_t GetNumAlive() const;
+	static float GetLifeTime(ParticleType type);
+private:
+	static void InitGraphics();
+	static unsigned int LoadTexture(const std::string& path);
+private:
+	//Keep in sync with Particle.vert
+	static constexpr float smokeTimePerFrame = 0.075f;
+	static constexpr int smokeFrames = 9;
+	static constexpr float plus5LifeTime = 0.9f;
+
+	//The quad uses locations 0 and 1, per instance data starts here
+	static constexpr unsigned int spawnPositionAttribLocation = 2;
+	static constexpr unsigned int spawnTimeAttribLocation = 3;
+	static constexpr unsigned int typeAttribLocation = 4;
+
+	//Shared by all pools
+	static bool graphicsInitialised;
+	static unsigned int vao;
+	static unsigned int vbo;
+	static unsigned int ebo;
+	static std::unique_ptr<Shader> shader;
+	static UniformHandle timeHandle;
+
+	const ParticleType type;
+	const float lifeTime;
+	unsigned int texture = 0;
+
+	std::vector<InstanceData> particles;	//Sized to the capacity once, used as a ring buffer
+	size_t first = 0;	//Oldest particle
+	size_t nAlive = 0;
+	float time = 0.0f;	//Restarts whenever the pool is empty, so it never grows large enough to lose precision
+};
\ No newline at end of file
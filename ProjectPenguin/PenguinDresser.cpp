@@ -65,11 +65,11 @@ std::vector<Accessory> PenguinDresser::GeneratePenguinOutfit()
 				break;
 			case 1:
 				//Bobblehead
-				result.emplace_back("BubbleHead.gltf", "head", "SmoothShader.vert", "SmoothBright.frag");
+				result.emplace_back("BubbleHead.gltf", "head", "SmoothShaderInstanced.vert", "SmoothBright.frag");
 				break;
 			case 2:
 				//Stealth
-				result.emplace_back("CardboardBox.gltf", "head", "SmoothShader.vert", "SmoothBright.frag");
+				result.emplace_back("CardboardBox.gltf", "head", "SmoothShaderInstanced.vert", "SmoothBright.frag");
 				break;
 			case 3:
 				//King
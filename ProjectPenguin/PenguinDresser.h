@@ -6,7 +6,7 @@
 
 struct Accessory
 {
-	Accessory(std::string name, std::string bone, std::string vertShader = "CelShader.vert", std::string fragShader = "CelShader.frag")
+	Accessory(std::string name, std::string bone, std::string vertShader = "CelShaderInstanced.vert", std::string fragShader = "CelShader.frag")
 		:
 		name(name),
 		bone(bone),
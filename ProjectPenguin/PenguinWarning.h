@@ -1,29 +1,19 @@
 #pragma once
 
-/*REPLACE: could have done some kind of instancing for this class.
-Storing the same texture, vbo, vao, ebo, etc. for each instance is not necessary*/
-//REPLACE: if not instancing, at least fix memory leak that's likely present
-
-
 #include "glm/glm.hpp"
 
-#include "Shader.h"
-
-#include <memory>
-
 class Camera;
+class UISpriteBatch;
 
 class PenguinWarning
 {
 public:
-	PenguinWarning();
-	static void PreLoad();
+	PenguinWarning() = default;
 
 	void Update(glm::vec3 penguinPos, const Camera& camera, glm::vec2 windowDimensions);
 	void UpdateWidth(float width);
 
-	static void BindGraphics();
-	void Draw();
+	void Draw(UISpriteBatch& batch) const;
 
 	float GetHeight() const;
 
@@ -37,19 +27,4 @@ private:
 	float width = 0.05f;	//Width depends on window aspect ratio
 	static constexpr float yMinBorderDistance = 0.1f;	//minimum distance from window border (icon doesn't leave edge of screen)
 	static constexpr float yOffset = 1.0f;	//Y offset from penguin position (so it doesn't appear at its feet)
-
-	//Graphics
-	static bool preloaded;	//Must be true before an object of this class is created
-
-	//Geometry
-	static unsigned int vao;
-	static unsigned int vbo;
-	static unsigned int ebo;
-
-	//Shader
-	static std::unique_ptr<Shader> shader;
-
-	//Texture
-	static unsigned int redTexture;
-	static unsigned int yellowTexture;
 };
\ No newline at end of file
@@ -1,43 +1,28 @@
 #include "Plus5EffectDispenser.h"
 
 Plus5EffectDispenser::Plus5EffectDispenser()
+	:
+	plus5Effects(ParticleType::Plus5, "UI/+5.png", maxPlus5Effects)
 {
-	Plus5Effect::PreLoad();
 }
 
 void Plus5EffectDispenser::Dispense(glm::vec3 pos)
 {
-	plus5Effects.emplace_back(pos);
+	plus5Effects.Spawn(pos);
 }
 
 void Plus5EffectDispenser::Update(float deltaTime)
 {
-	//Update effects
-	for (Plus5Effect& plus5 : plus5Effects)
-	{
-		plus5.Update(deltaTime);
-	}
-	//Remove redundant effects
-	{
-		const auto newEnd = std::remove_if(plus5Effects.begin(), plus5Effects.end(),
-			[](Plus5Effect& plus5)
-			{
-				return plus5.IsFinished();
-			});
-		plus5Effects.erase(newEnd, plus5Effects.end());
-	}
+	//Finished effects are removed by the particle system
+	plus5Effects.Update(deltaTime);
 }
 
-void Plus5EffectDispenser::Draw(const Camera& camera)
+void Plus5EffectDispenser::Draw(StreamBuffer& streamBuffer)
 {
-	Plus5Effect::BindGraphics();
-	for (Plus5Effect& plus5 : plus5Effects)
-	{
-		plus5.Draw(camera);
-	}
+	plus5Effects.Draw(streamBuffer);
 }
 
 void Plus5EffectDispenser::Clear()
 {
-	plus5Effects.clear();
-}
+	plus5Effects.Clear();
+}
\ No newline at end of file
@@ -1,10 +1,8 @@
 #pragma once
 
-#include "Plus5Effect.h"
+#include "ParticleSystem.h"
 
-class Camera;
-
-//This class handles spawning and destroying the smoke particle effect
+//This class handles spawning and destroying the +5 effect
 
 class Plus5EffectDispenser
 {
@@ -12,8 +10,9 @@ public:
 	Plus5EffectDispenser();
 	void Dispense(glm::vec3 pos);
 	void Update(float deltaTime);
-	void Draw(const Camera& camera);
+	void Draw(StreamBuffer& streamBuffer);
 	void Clear();
 private:
-	std::vector<Plus5Effect> plus5Effects;
+	static constexpr size_t maxPlus5Effects = 16;
+	ParticleSystem plus5Effects;
 };
\ No newline at end of file
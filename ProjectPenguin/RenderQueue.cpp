@@ -0,0 +1,279 @@
+#include "RenderQueue.h"
+
+#include <glad/glad.h>
+
+#include <sstream>
+#include <algorithm>
+
+#include "Shader.h"
+#include "GlGetError.h"
+#include "GlState.h"
+
+void RenderQueue::SetViewPos(glm::vec3 pos)
+{
+	viewPos = pos;
+}
+
+glm::vec3 RenderQueue::GetViewPos() const
+{
+	return viewPos;
+}
+
+void RenderQueue::Submit(RenderPass pass, const Shader& shader, unsigned int texture, unsigned int vao, size_t nIndices, size_t nInstances, float depth,
+	const DrawOptions& options)
+{
+	const bool frontToBack = pass == RenderPass::DepthPrepass || (pass == RenderPass::Opaque && !depthPrepass);
+	commands.push_back({ MakeKey(pass, shader.Get(), texture, vao, depth, frontToBack), &shader, texture, vao, (unsigned int)nIndices, (unsigned int)nInstances, options });
+}
+
+void RenderQueue::SubmitOpaque(const Shader& shader, const Shader& depthShader, unsigned int texture, unsigned int vao, size_t nIndices, size_t nInstances,
+	float depth, const DrawOptions& options)
+{
+	//The instance data is already uploaded, the pre-pass draws the exact same instances with a cheaper program
+	if (depthPrepass)
+	{
+		Submit(RenderPass::DepthPrepass, depthShader, 0, vao, nIndices, nInstances, depth, options);
+	}
+	Submit(RenderPass::Opaque, shader, texture, vao, nIndices, nInstances, depth, options);
+}
+
+void RenderQueue::Execute()
+{
+	RadixSort(commands, sortBuffer);
+
+	const bool multiDraw = GlCapabilities::HasMultiDrawIndirect();
+	if (multiDraw && !commands.empty())
+	{
+		UploadIndirectCommands();
+	}
+
+	//State is unknown at the start of every execution
+	const unsigned int unknown = ~0u;
+	unsigned int currentProgram = unknown;
+	unsigned int currentTexture = unknown;
+	unsigned int currentVao = unknown;
+	RenderPass currentPass = RenderPass::Shadow;
+	bool depthPrepassDrawn = false;
+
+	GlState::ActiveTexture(0);
+	for (size_t i = 0; i < commands.size();)
+	{
+		const Command& command = commands[i];
+		RenderPass pass = GetPass(command.key);
+		if (pass != currentPass)
+		{
+			BeginPass(pass, depthPrepassDrawn);
+			currentPass = pass;
+			depthPrepassDrawn = depthPrepassDrawn || pass == RenderPass::DepthPrepass;
+		}
+		if (command.shader->Get() != currentProgram)
+		{
+			command.shader->Use();
+			currentProgram = command.shader->Get();
+			stats.nProgramChanges++;
+		}
+		if (command.texture != currentTexture)
+		{
+			GlState::BindTexture(command.options.textureArray ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, command.texture);
+			currentTexture = command.texture;
+			stats.nTextureChanges++;
+		}
+		if (command.vao != currentVao)
+		{
+			GlState::BindVertexArray(command.vao);
+			currentVao = command.vao;
+			stats.nVaoChanges++;
+		}
+
+		//Find the commands that can be drawn along with this one
+		size_t end = i + 1;
+		if (multiDraw)
+		{
+			while (end < commands.size() && SharesState(command, commands[end]))
+			{
+				end++;
+			}
+		}
+
+		GLenum indexType = command.options.uintIndices ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+		if (multiDraw)
+		{
+			//Single commands go through the indirect buffer too, a plain draw call would ignore their base instance
+			GlCapabilities::MultiDrawElementsIndirect(GL_TRIANGLES,
+				indexType,
+				i * sizeof(GlCapabilities::DrawElementsIndirectCommand),
+				(int)(end - i));
+			if (end - i > 1)
+			{
+				stats.nMultiDraws++;
+			}
+		}
+		else
+		{
+			size_t indexSize = command.options.uintIndices ? sizeof(unsigned int) : sizeof(unsigned short);
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+				(GLsizei)command.nIndices,
+				indexType,
+				(char*)0 + command.options.firstIndex * indexSize,
+				(GLsizei)command.nInstances,
+				command.options.baseVertex);
+		}
+		stats.nDraws++;
+		for (; i < end; i++)
+		{
+			stats.nInstances += commands[i].nInstances;
+		}
+	}
+	GlState::BindVertexArray(0);
+	if (currentPass != RenderPass::Shadow)
+	{
+		//Back to the defaults for everything drawn outside of the queue
+		BeginPass(RenderPass::Shadow, false);
+	}
+	GL_ERROR_CHECK();
+
+	commands.clear();
+}
+
+void RenderQueue::BeginPass(RenderPass pass, bool depthPrepassDrawn)
+{
+	switch (pass)
+	{
+	case RenderPass::DepthPrepass:
+		GlState::ColorMask(false);
+		GlState::DepthMask(true);
+		GlState::DepthFunc(GL_LESS);
+		break;
+	case RenderPass::Opaque:
+		//After a pre-pass the depth buffer is already complete, only the nearest fragment passes and nothing needs to be written
+		GlState::ColorMask(true);
+		GlState::DepthMask(!depthPrepassDrawn);
+		GlState::DepthFunc(depthPrepassDrawn ? GL_EQUAL : GL_LESS);
+		break;
+	default:
+		GlState::ColorMask(true);
+		GlState::DepthMask(true);
+		GlState::DepthFunc(GL_LESS);
+		break;
+	}
+}
+
+void RenderQueue::UploadIndirectCommands()
+{
+	indirectCommands.clear();
+	for (const Command& command : commands)
+	{
+		indirectCommands.push_back({ command.nIndices,
+			command.nInstances,
+			command.options.firstIndex,
+			command.options.baseVertex,
+			command.options.baseInstance });
+	}
+
+	//Orphaned every time, the previous contents may still be in use by the GPU.
+	//The binding isn't part of the vao state, so it can stay bound while drawing
+	if (indirectBuffer == 0)
+	{
+		glGenBuffers(1, &indirectBuffer);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER,
+		indirectCommands.size() * sizeof(GlCapabilities::DrawElementsIndirectCommand),
+		indirectCommands.data(),
+		GL_STREAM_DRAW);
+	GL_ERROR_CHECK();
+}
+
+void RenderQueue::Clear()
+{
+	commands.clear();
+}
+
+const RenderQueue::Stats& RenderQueue::GetStats() const
+{
+	return stats;
+}
+
+void RenderQueue::ResetStats()
+{
+	stats = Stats();
+}
+
+void RenderQueue::SetDepthPrepass(bool enabled)
+{
+	depthPrepass = enabled;
+}
+
+bool RenderQueue::UsesDepthPrepass() const
+{
+	return depthPrepass;
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, unsigned int program, unsigned int texture, unsigned int vao, float depth, bool frontToBack)
+{
+	//Quantize depth, nearer batches get lower keys
+	const uint64_t maxDepthValue = (uint64_t(1) << depthBits) - 1;
+	uint64_t depthValue = (uint64_t)(glm::clamp(depth / maxDepth, 0.0f, 1.0f) * (float)maxDepthValue);
+
+	//GL object names are small, masking them only matters in theory
+	uint64_t key = (uint64_t)pass & ((uint64_t(1) << passBits) - 1);
+	if (frontToBack)
+	{
+		key = (key << depthBits) | depthValue;
+	}
+	key = (key << programBits) | ((uint64_t)program & ((uint64_t(1) << programBits) - 1));
+	key = (key << textureBits) | ((uint64_t)texture & ((uint64_t(1) << textureBits) - 1));
+	key = (key << vaoBits) | ((uint64_t)vao & ((uint64_t(1) << vaoBits) - 1));
+	if (!frontToBack)
+	{
+		key = (key << depthBits) | depthValue;
+	}
+	return key;
+}
+
+RenderPass RenderQueue::GetPass(uint64_t key)
+{
+	return (RenderPass)(key >> (64 - passBits));
+}
+
+bool RenderQueue::SharesState(const Command& lhs, const Command& rhs)
+{
+	return lhs.shader->Get() == rhs.shader->Get()
+		&& lhs.texture == rhs.texture
+		&& lhs.vao == rhs.vao
+		&& lhs.options.textureArray == rhs.options.textureArray
+		&& lhs.options.uintIndices == rhs.options.uintIndices;
+}
+
+void RenderQueue::RadixSort(std::vector<Command>& commands, std::vector<Command>& scratch)
+{
+	//LSD radix sort, 8 bits per pass. Stable, so equal keys keep their submission order
+	scratch.resize(commands.size());
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256] = {};
+		for (const Command& command : commands)
+		{
+			counts[(command.key >> shift) & 0xFF]++;
+		}
+
+		//Skip bytes that are the same for every key, which is most of them in a typical frame
+		if (commands.empty() || counts[(commands.front().key >> shift) & 0xFF] == commands.size())
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t& count : counts)
+		{
+			size_t bucketSize = count;
+			count = offset;
+			offset += bucketSize;
+		}
+		for (const Command& command : commands)
+		{
+			scratch[counts[(command.key >> shift) & 0xFF]++] = command;
+		}
+		commands.swap(scratch);
+	}
+}
\ No newline at end of file
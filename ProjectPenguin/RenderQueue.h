@@ -0,0 +1,105 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <vector>
+#include <cstdint>
+
+#include "GlCapabilities.h"
+
+class Shader;
+
+//Passes are executed in this order, the pass is stored in the most significant bits of the sort key
+enum class RenderPass : unsigned int
+{
+	Shadow = 0,
+	DepthPrepass,	//Only writes depth, so the opaque pass after it only shades visible fragments
+	Opaque
+};
+
+//Parts of a draw call that only batched geometry needs, the defaults fit a regular model
+struct DrawOptions
+{
+	bool textureArray = false;	//Bind the texture as GL_TEXTURE_2D_ARRAY instead of GL_TEXTURE_2D
+	bool uintIndices = false;	//32 bit indices instead of 16 bit ones
+	unsigned int firstIndex = 0;	//Draw a range of the index buffer, so several batches can share one
+	int baseVertex = 0;	//Added to every index, so several meshes can share one vertex buffer
+	unsigned int baseInstance = 0;	//First instance to read from the vao, needs GlCapabilities::HasMultiDrawIndirect
+};
+
+//Collects the draw calls of a frame and executes them sorted by a 64 bit key,
+//so that programs, textures and vaos are bound as rarely as possible.
+//Layout of the key (most significant first): pass | program | texture | vao | depth
+//Passes that benefit from early depth testing are sorted front to back instead: pass | depth | program | texture | vao
+//That's the depth pre-pass, or the opaque pass when there is no pre-pass. After a pre-pass, the opaque pass
+//only draws fragments with exactly the depth from the pre-pass, so it can be sorted by state.
+//When multi draw indirect is supported, consecutive commands that bind the same state are drawn in one call.
+class RenderQueue
+{
+public:
+	struct Command
+	{
+		uint64_t key;
+		const Shader* shader;
+		unsigned int texture;
+		unsigned int vao;
+		unsigned int nIndices;
+		unsigned int nInstances;
+		DrawOptions options;
+	};
+	struct Stats
+	{
+		unsigned int nDraws = 0;
+		unsigned int nInstances = 0;
+		unsigned int nProgramChanges = 0;
+		unsigned int nTextureChanges = 0;
+		unsigned int nVaoChanges = 0;
+		unsigned int nMultiDraws = 0;	//Draw calls that drew more than one command
+	};
+public:
+	void SetViewPos(glm::vec3 pos);
+	glm::vec3 GetViewPos() const;
+
+	//Instance data must already be uploaded, the command only stores which state to bind
+	void Submit(RenderPass pass, const Shader& shader, unsigned int texture, unsigned int vao, size_t nIndices, size_t nInstances, float depth,
+		const DrawOptions& options = DrawOptions());
+	//Submits to the opaque pass, and to the depth pre-pass with depthShader when it's enabled
+	void SubmitOpaque(const Shader& shader, const Shader& depthShader, unsigned int texture, unsigned int vao, size_t nIndices, size_t nInstances,
+		float depth, const DrawOptions& options = DrawOptions());
+	//Draw everything submitted since the last call
+	void Execute();
+	//Drop everything submitted since the last call without drawing it
+	void Clear();
+
+	const Stats& GetStats() const;
+	void ResetStats();
+
+	void SetDepthPrepass(bool enabled);
+	bool UsesDepthPrepass() const;
+
+	static uint64_t MakeKey(RenderPass pass, unsigned int program, unsigned int texture, unsigned int vao, float depth, bool frontToBack = false);
+	static RenderPass GetPass(uint64_t key);
+	static void RadixSort(std::vector<Command>& commands, std::vector<Command>& scratch);
+	//Whether two sorted commands can go in the same multi draw
+	static bool SharesState(const Command& lhs, const Command& rhs);
+private:
+	void UploadIndirectCommands();
+	//Sets the depth and colour writes of a pass, depthPrepassDrawn tells the opaque pass which depth test to use
+	static void BeginPass(RenderPass pass, bool depthPrepassDrawn);
+private:
+	std::vector<Command> commands;
+	std::vector<Command> sortBuffer;
+	std::vector<GlCapabilities::DrawElementsIndirectCommand> indirectCommands;	//One per command, in sorted order
+	unsigned int indirectBuffer = 0;
+	Stats stats;
+	glm::vec3 viewPos = glm::vec3(0.0f);
+	bool depthPrepass = false;
+
+	//Bit layout of the sort key
+	static constexpr int depthBits = 16;
+	static constexpr int vaoBits = 12;
+	static constexpr int textureBits = 16;
+	static constexpr int programBits = 16;
+	static constexpr int passBits = 4;
+	static constexpr float maxDepth = 100.0f;	//Everything further away than this ends up in the last depth bucket
+};
\ No newline at end of file
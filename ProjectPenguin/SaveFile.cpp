@@ -24,7 +24,12 @@ void SaveFile::LoadData(std::string fileName)
 		//Load data
 		highScore = *data.find("highScore");
 		shadowResolution = *data.find("shadowResolution");
+		shadowUpdateInterval = data.value("shadowUpdateInterval", 1);	//Not present in older save files
 		msaa = *data.find("msaa");
+		dynamicResolutionOn = data.value("dynamicResolutionOn", true);	//Not present in older save files
+		targetFrameRate = data.value("targetFrameRate", 60);
+		minResolutionScale = data.value("minResolutionScale", 0.5f);
+		depthPrepassOn = data.value("depthPrepassOn", true);
 		selectedMonitor = *data.find("selectedMonitor");
 		fullScreenOn = *data.find("fullScreenOn");
 	}
@@ -36,7 +41,12 @@ void SaveFile::SaveData(std::string fileName)
 	nlohmann::json data = {
 		{"highScore", highScore},
 		{"shadowResolution", shadowResolution},
+		{"shadowUpdateInterval", shadowUpdateInterval},
 		{"msaa", msaa},
+		{"dynamicResolutionOn", dynamicResolutionOn},
+		{"targetFrameRate", targetFrameRate},
+		{"minResolutionScale", minResolutionScale},
+		{"depthPrepassOn", depthPrepassOn},
 		{"selectedMonitor", selectedMonitor},
 		{"fullScreenOn", fullScreenOn}
 	};
@@ -77,11 +87,36 @@ unsigned int SaveFile::GetShadowRes() const
 	return shadowResolution;
 }
 
+int SaveFile::GetShadowUpdateInterval() const
+{
+	return shadowUpdateInterval;
+}
+
 unsigned int SaveFile::GetMsaaQuality() const
 {
 	return msaa;
 }
 
+bool SaveFile::GetDynamicResolutionOn() const
+{
+	return dynamicResolutionOn;
+}
+
+int SaveFile::GetTargetFrameRate() const
+{
+	return targetFrameRate;
+}
+
+float SaveFile::GetMinResolutionScale() const
+{
+	return minResolutionScale;
+}
+
+bool SaveFile::GetDepthPrepassOn() const
+{
+	return depthPrepassOn;
+}
+
 int SaveFile::GetSelectedMonitor() const
 {
 	return selectedMonitor;
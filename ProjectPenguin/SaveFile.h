@@ -18,7 +18,12 @@ public:
 
 	//Settings
 	unsigned int GetShadowRes() const;
+	int GetShadowUpdateInterval() const;
 	unsigned int GetMsaaQuality() const;
+	bool GetDynamicResolutionOn() const;
+	int GetTargetFrameRate() const;
+	float GetMinResolutionScale() const;
+	bool GetDepthPrepassOn() const;
 	int GetSelectedMonitor() const;
 	bool GetFullScreenOn() const;
 
@@ -29,7 +34,12 @@ private:
 
 	//Graphics settings
 	unsigned int shadowResolution = 1024;
+	int shadowUpdateInterval = 1;	//Dynamic shadows are rendered once every this many frames
 	unsigned int msaa = 4;
+	bool dynamicResolutionOn = true;	//Render the scene below the window resolution when frames take too long
+	int targetFrameRate = 60;
+	float minResolutionScale = 0.5f;
+	bool depthPrepassOn = true;	//Lay down depth first, so only visible fragments run the lighting shaders
 	int selectedMonitor = -1;
 	bool fullScreenOn = true;
 
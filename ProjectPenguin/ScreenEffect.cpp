@@ -3,7 +3,12 @@
 ScreenEffect::ScreenEffect()
 	:
 	noEffect("PassToFragBackground.vert", "PassToScreen.frag"),
-	flashEffect("PassToFragBackground.vert", "FlashEffect.frag")
+	flashEffect("PassToFragBackground.vert", "FlashEffect.frag"),
+	noEffectTexcoordScaleHandle(noEffect.GetUniformHandle("texcoordScale")),
+	flashTexcoordScaleHandle(flashEffect.GetUniformHandle("texcoordScale")),
+	noEffectMaxTexcoordHandle(noEffect.GetUniformHandle("maxTexcoord")),
+	flashMaxTexcoordHandle(flashEffect.GetUniformHandle("maxTexcoord")),
+	brightnessHandle(flashEffect.GetUniformHandle("brightness"))
 {
 }
 
@@ -21,16 +26,20 @@ void ScreenEffect::Update(float dt)
 	}
 }
 
-void ScreenEffect::UseEffect()
+void ScreenEffect::UseEffect(glm::vec2 texcoordScale, glm::vec2 maxTexcoord)
 {
 	switch (currentEffectType)
 	{
 	case EffectType::None:
 		noEffect.Use();
+		noEffect.Set(noEffectTexcoordScaleHandle, texcoordScale);
+		noEffect.Set(noEffectMaxTexcoordHandle, maxTexcoord);
 		break;
 	case EffectType::Flash:
 		flashEffect.Use();
-		flashEffect.SetUniformFloat("brightness", flashCurrentTime / flashDuration);
+		flashEffect.Set(flashTexcoordScaleHandle, texcoordScale);
+		flashEffect.Set(flashMaxTexcoordHandle, maxTexcoord);
+		flashEffect.Set(brightnessHandle, flashCurrentTime / flashDuration);
 		break;
 	}
 }
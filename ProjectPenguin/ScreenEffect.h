@@ -14,7 +14,7 @@ public:
 	ScreenEffect();
 
 	void Update(float dt);
-	void UseEffect();
+	void UseEffect(glm::vec2 texcoordScale, glm::vec2 maxTexcoord);
 
 	EffectType GetCurrentEffectType() const;
 
@@ -25,6 +25,11 @@ private:
 
 	Shader noEffect;
 	Shader flashEffect;
+	UniformHandle noEffectTexcoordScaleHandle;
+	UniformHandle flashTexcoordScaleHandle;
+	UniformHandle noEffectMaxTexcoordHandle;
+	UniformHandle flashMaxTexcoordHandle;
+	UniformHandle brightnessHandle;
 	float flashDuration;
 	float flashCurrentTime;
 };
\ No newline at end of file
@@ -6,14 +6,19 @@
 #include "SaveFile.h"
 
 //REMOVE use the proper error check method
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include "GlGetError.h"
+#include "GlState.h"
 
 ScreenQuad::ScreenQuad(const Window& window, const SaveFile& settings)
 	:
 	window(window),
-	settings(settings)
+	settings(settings),
+	dynamicResolution(1.0f / (float)settings.GetTargetFrameRate(), settings.GetMinResolutionScale()),
+	allocatedWidth(window.GetWidth()),
+	allocatedHeight(window.GetHeight())
 {
 	float vertices[] = {
 		1.0f, -1.0f,	1.0f, 0.0f,		//Top right
@@ -28,7 +33,7 @@ ScreenQuad::ScreenQuad(const Window& window, const SaveFile& settings)
 
 	//Generate VAO
 	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
+	GlState::BindVertexArray(vao);
 
 	//Generate VBO
 	glGenBuffers(1, &vbo);
@@ -54,17 +59,17 @@ ScreenQuad::ScreenQuad(const Window& window, const SaveFile& settings)
 
 	//Set up msFbo
 	glGenFramebuffers(1, &msFbo);
-	glBindFramebuffer(GL_FRAMEBUFFER, msFbo);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, msFbo);
 
 	//Generate msTexture
 	glGenTextures(1, &msTexture);
-	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, msTexture);
+	GlState::BindTexture(GL_TEXTURE_2D_MULTISAMPLE, msTexture);
 
 	GL_ERROR_CHECK();
 
 	//Set texture settings
-	glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, settings.GetMsaaQuality(), GL_RGB, window.GetWidth(), window.GetHeight(), GL_TRUE);
-	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+	glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, settings.GetMsaaQuality(), GL_RGB, allocatedWidth, allocatedHeight, GL_TRUE);
+	GlState::BindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 
 	GL_ERROR_CHECK();
 
@@ -78,7 +83,7 @@ ScreenQuad::ScreenQuad(const Window& window, const SaveFile& settings)
 	//Bind msRbo as depth and stencil attachment
 	//msaaQuality == nSamples
 	glBindRenderbuffer(GL_RENDERBUFFER, msRbo);
-	glRenderbufferStorageMultisample(GL_RENDERBUFFER, settings.GetMsaaQuality(), GL_DEPTH24_STENCIL8, window.GetWidth(), window.GetHeight());
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, settings.GetMsaaQuality(), GL_DEPTH24_STENCIL8, allocatedWidth, allocatedHeight);
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, msRbo);
 
@@ -88,20 +93,20 @@ ScreenQuad::ScreenQuad(const Window& window, const SaveFile& settings)
 
 	//Set up fbo
 	glGenFramebuffers(1, &fbo);
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, fbo);
 
 	//Generate texture
 	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	GlState::BindTexture(GL_TEXTURE_2D, texture);
 
 	//Set texture settings
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, window.GetWidth(), window.GetHeight(), 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, allocatedWidth, allocatedHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GlState::BindTexture(GL_TEXTURE_2D, 0);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	GL_ERROR_CHECK();
 }
@@ -109,7 +114,9 @@ ScreenQuad::ScreenQuad(const Window& window, const SaveFile& settings)
 void ScreenQuad::StartFrame()
 {
 	//Bind msFbo
-	glBindFramebuffer(GL_FRAMEBUFFER, msFbo);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, msFbo);
+	glm::ivec2 sceneSize = GetSceneSize();
+	GlState::Viewport(0, 0, sceneSize.x, sceneSize.y);
 	GL_ERROR_CHECK();
 
 	//Clear buffer
@@ -127,7 +134,7 @@ void ScreenQuad::StartFrame()
 void ScreenQuad::EndFrame()
 {
 	//Bind fbo
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, fbo);
 
 	//REMOVE this check?
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
@@ -136,39 +143,49 @@ void ScreenQuad::EndFrame()
 		throw std::exception("ERROR::FRAMEBUFFER:: Framebuffer is not complete!");
 	}
 
-	//Copy from msFbo to fbo
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, msFbo);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
-	glBlitFramebuffer(0, 0, window.GetWidth(), window.GetHeight(), 0, 0, window.GetWidth(), window.GetHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	//Copy from msFbo to fbo, resolving requires both rectangles to be the same size. Upscaling happens when the quad is drawn
+	glm::ivec2 sceneSize = GetSceneSize();
+	GlState::BindFramebuffer(GL_READ_FRAMEBUFFER, msFbo);
+	GlState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+	glBlitFramebuffer(0, 0, sceneSize.x, sceneSize.y, 0, 0, sceneSize.x, sceneSize.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-	//Unbind
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	//Unbind, everything after this (the quad and the UI) is drawn at the window resolution
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlState::Viewport(0, 0, window.GetWidth(), window.GetHeight());
 }
 
 void ScreenQuad::Draw()
 {
-	glBindVertexArray(vao);
+	GlState::BindVertexArray(vao);
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
+	GlState::BindVertexArray(0);
 }
 
 void ScreenQuad::UpdateDimensions()
 {
+	//Attachments only grow, a smaller window just renders to a smaller part of them
+	if (window.GetWidth() <= allocatedWidth && window.GetHeight() <= allocatedHeight)
+	{
+		return;
+	}
+	allocatedWidth = std::max(allocatedWidth, window.GetWidth());
+	allocatedHeight = std::max(allocatedHeight, window.GetHeight());
+
 	//--------------------------------------------------
 	//-------------- Update msFbo ----------------------
 	//--------------------------------------------------
 
-	glBindFramebuffer(GL_FRAMEBUFFER, msFbo);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, msFbo);
 
 	//Update msTexture
-	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, msTexture);
-	glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, settings.GetMsaaQuality(), GL_RGB, window.GetWidth(), window.GetHeight(), GL_TRUE);
-	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+	GlState::BindTexture(GL_TEXTURE_2D_MULTISAMPLE, msTexture);
+	glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, settings.GetMsaaQuality(), GL_RGB, allocatedWidth, allocatedHeight, GL_TRUE);
+	GlState::BindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, msTexture, 0);
 
 	//Update msRbo
 	glBindRenderbuffer(GL_RENDERBUFFER, msRbo);
-	glRenderbufferStorageMultisample(GL_RENDERBUFFER, settings.GetMsaaQuality(), GL_DEPTH24_STENCIL8, window.GetWidth(), window.GetHeight());
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, settings.GetMsaaQuality(), GL_DEPTH24_STENCIL8, allocatedWidth, allocatedHeight);
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, msRbo);
 
@@ -176,20 +193,48 @@ void ScreenQuad::UpdateDimensions()
 	//-------------- Update regular fbo ----------------
 	//--------------------------------------------------
 
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, fbo);
 
 	//Update texture
-	glBindTexture(GL_TEXTURE_2D, texture);
+	GlState::BindTexture(GL_TEXTURE_2D, texture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, window.GetWidth(), window.GetHeight(), 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, allocatedWidth, allocatedHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GlState::BindTexture(GL_TEXTURE_2D, 0);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ScreenQuad::UpdateResolutionScale(float frameTime)
+{
+	if (settings.GetDynamicResolutionOn())
+	{
+		resolutionScale = dynamicResolution.Update(frameTime);
+	}
 }
 
 unsigned int ScreenQuad::GetTexture() const
 {
 	return texture;
 }
+
+glm::ivec2 ScreenQuad::GetSceneSize() const
+{
+	return glm::ivec2(
+		std::max(1, (int)((float)window.GetWidth() * resolutionScale + 0.5f)),
+		std::max(1, (int)((float)window.GetHeight() * resolutionScale + 0.5f)));
+}
+
+glm::vec2 ScreenQuad::GetTexcoordScale() const
+{
+	glm::ivec2 sceneSize = GetSceneSize();
+	return glm::vec2((float)sceneSize.x / (float)allocatedWidth, (float)sceneSize.y / (float)allocatedHeight);
+}
+
+
+glm::vec2 ScreenQuad::GetMaxTexcoord() const
+{
+	glm::vec2 sceneSize = GetSceneSize();
+	return glm::vec2((sceneSize.x - 0.5f) / (float)allocatedWidth, (sceneSize.y - 0.5f) / (float)allocatedHeight);
+}
\ No newline at end of file
@@ -1,9 +1,15 @@
 #pragma once
 
+#include "glm/glm.hpp"
+
+#include "DynamicResolution.h"
+
 class Window;
 class SaveFile;
 
 //Used for post processing
+//The scene can be rendered below the window resolution, into the bottom left corner of the attachments.
+//Attachments are only reallocated when the window grows, so changing the resolution scale is free.
 class ScreenQuad
 {
 public:
@@ -13,8 +19,12 @@ public:
 	void EndFrame();
 	void Draw();
 	void UpdateDimensions();
+	void UpdateResolutionScale(float frameTime);
 
 	unsigned int GetTexture() const;
+	glm::ivec2 GetSceneSize() const;	//Size of the part of the texture the scene was rendered to
+	glm::vec2 GetTexcoordScale() const;	//Maps texture coordinates of the full quad onto the scene
+	glm::vec2 GetMaxTexcoord() const;	//Centre of the last texel of the scene, linear filtering past this would blend in texels outside of it
 private:
 	//Geometry
 	unsigned int vao = 0;
@@ -35,4 +45,10 @@ private:
 	//Settings
 	const Window& window;
 	const SaveFile& settings;
+
+	//Resolution
+	DynamicResolution dynamicResolution;
+	float resolutionScale = 1.0f;
+	int allocatedWidth = 0;
+	int allocatedHeight = 0;
 };
\ No newline at end of file
@@ -3,10 +3,17 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 #include <glad/glad.h>
 
 #include "GlGetError.h"
+#include "GlState.h"
+#include "UniformBuffer.h"
+
+//Static members
+unsigned int Shader::nStringLookups = 0;
+std::unordered_map<std::string, std::unique_ptr<Shader>> Shader::sharedShaders;
 
 Shader::Shader(std::string vertexName, std::string fragmentName)
 	:
@@ -15,6 +22,12 @@ Shader::Shader(std::string vertexName, std::string fragmentName)
 }
 
 Shader::Shader(std::string vertexName, std::string fragmentName, std::string geometryName)
+	:
+	Shader(vertexName, fragmentName, geometryName, "")
+{
+}
+
+Shader::Shader(std::string vertexName, std::string fragmentName, std::string geometryName, std::string defines)
 {
 	bool useGeometryShader = !geometryName.empty();
 	GL_ERROR_CHECK();
@@ -35,6 +48,15 @@ Shader::Shader(std::string vertexName, std::string fragmentName, std::string geo
 	{
 		geometryCode = FromFile(geometryPath);
 	}
+	if (!defines.empty())
+	{
+		vertexCode = InjectDefines(vertexCode, defines);
+		fragmentCode = InjectDefines(fragmentCode, defines);
+		if (useGeometryShader)
+		{
+			geometryCode = InjectDefines(geometryCode, defines);
+		}
+	}
 
 	//Compile shaders
 	unsigned int vertexShader = CreateShader(vertexName, vertexCode.c_str(), GL_VERTEX_SHADER);
@@ -85,6 +107,52 @@ Shader::Shader(std::string vertexName, std::string fragmentName, std::string geo
 		glDeleteShader(geometryShader);
 	}
 	GL_ERROR_CHECK();
+
+	ReflectUniforms();
+	BindUniformBlocks();
+}
+
+Shader::Shader(std::string vertexName, const std::vector<std::string>& feedbackVaryings)
+{
+	GL_ERROR_CHECK();
+
+	std::string vertexPath = "Shaders/";
+	vertexPath.append(vertexName);
+	std::string vertexCode = FromFile(vertexPath);
+	unsigned int vertexShader = CreateShader(vertexName, vertexCode.c_str(), GL_VERTEX_SHADER);
+
+	//Varyings have to be known before linking
+	std::vector<const char*> varyingNames;
+	for (const std::string& varying : feedbackVaryings)
+	{
+		varyingNames.push_back(varying.c_str());
+	}
+
+	shaderProgram = glCreateProgram();
+	assert(shaderProgram > 0);
+	glAttachShader(shaderProgram, vertexShader);
+	glTransformFeedbackVaryings(shaderProgram, (GLsizei)varyingNames.size(), varyingNames.data(), GL_INTERLEAVED_ATTRIBS);
+	glLinkProgram(shaderProgram);
+	{
+		int  success;
+		char infoLog[512];
+		glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::LINKING_FAILED\n" << infoLog << std::endl;
+			std::string errorMessage = "Could not link transform feedback shader ";
+			errorMessage.append(vertexName);
+			errorMessage.append("\n\ninfoLog:\n");
+			errorMessage.append(infoLog);
+			throw std::exception(errorMessage.c_str());
+		}
+	}
+	glDeleteShader(vertexShader);
+	GL_ERROR_CHECK();
+
+	ReflectUniforms();
+	BindUniformBlocks();
 }
 
 Shader::~Shader()
@@ -97,11 +165,23 @@ Shader::~Shader()
 
 Shader::Shader(Shader&& rhs) noexcept
 	:
-	shaderProgram(rhs.shaderProgram)
+	shaderProgram(rhs.shaderProgram),
+	uniformLocations(std::move(rhs.uniformLocations))
 {
 	rhs.shaderProgram = 0;
 }
 
+const Shader& Shader::GetShared(std::string vertexName, std::string fragmentName, std::string geometryName, std::string defines)
+{
+	std::string key = vertexName + "|" + fragmentName + "|" + geometryName + "|" + defines;
+	auto it = sharedShaders.find(key);
+	if (it == sharedShaders.end())
+	{
+		it = sharedShaders.emplace(key, std::make_unique<Shader>(vertexName, fragmentName, geometryName, defines)).first;
+	}
+	return *it->second;
+}
+
 unsigned int Shader::Get() const
 {
 	return shaderProgram;
@@ -110,81 +190,227 @@ unsigned int Shader::Get() const
 void Shader::Use() const
 {
 	GL_ERROR_CHECK();
-	glUseProgram(shaderProgram);
+	GlState::UseProgram(shaderProgram);
 	GL_ERROR_CHECK();
 }
 
 void Shader::SetUniformBool(const std::string& name, bool value) const
 {
-	glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), (int)value);
+	glUniform1i(FindUniformLocation(name), (int)value);
 }
 
 void Shader::SetUniformInt(const std::string& name, int value) const
 {
-	glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), value);
+	glUniform1i(FindUniformLocation(name), value);
 }
 
 void Shader::SetUniformFloat(const std::string& name, float value) const
 {
-	glUniform1f(glGetUniformLocation(shaderProgram, name.c_str()), value);
+	glUniform1f(FindUniformLocation(name), value);
 }
 
 void Shader::SetUniformVec2(const std::string& name, const glm::vec2& value) const
 {
-	glUniform2fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, &value[0]);
+	glUniform2fv(FindUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::SetUniformVec2(const std::string& name, float x, float y) const
 {
-	glUniform2f(glGetUniformLocation(shaderProgram, name.c_str()), x, y);
+	glUniform2f(FindUniformLocation(name), x, y);
 }
 
 void Shader::SetUniformVec3(const std::string& name, const glm::vec3& value) const
 {
-	glUniform3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, &value[0]);
+	glUniform3fv(FindUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::SetUniformVec3(const std::string& name, float x, float y, float z) const
 {
-	glUniform3f(glGetUniformLocation(shaderProgram, name.c_str()), x, y, z);
+	glUniform3f(FindUniformLocation(name), x, y, z);
 }
 
 void Shader::SetUniformVec4(const std::string& name, const glm::vec4& value) const
 {
-	glUniform4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, &value[0]);
+	glUniform4fv(FindUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::SetUniformVec4(const std::string& name, float x, float y, float z, float w) const
 {
-	glUniform4f(glGetUniformLocation(shaderProgram, name.c_str()), x, y, z, w);
+	glUniform4f(FindUniformLocation(name), x, y, z, w);
 }
 
 void Shader::SetUniformMat2(const std::string& name, const glm::mat2& mat) const
 {
-	glUniformMatrix2fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	glUniformMatrix2fv(FindUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::SetUniformMat3(const std::string& name, const glm::mat3& mat) const
 {
-	glUniformMatrix3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	glUniformMatrix3fv(FindUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::SetUniformMat4(const std::string& name, const glm::mat4& mat) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	glUniformMatrix4fv(FindUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::SetUniformMat4Array(const std::string& name, const std::vector<glm::mat4>& values) const
 {
 	if (!values.empty())
 	{
-		glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name.c_str()), (GLsizei)values.size(), GL_FALSE, &values.front()[0][0]);
+		glUniformMatrix4fv(FindUniformLocation(name), (GLsizei)values.size(), GL_FALSE, &values.front()[0][0]);
 	}
 }
 
 void Shader::SetUniformVec3Array(const std::string& name, const std::vector<glm::vec3>& values) const
 {
-	glUniform3fv(glGetUniformLocation(shaderProgram, name.c_str()), (GLsizei)values.size(), &values.front()[0]);
+	glUniform3fv(FindUniformLocation(name), (GLsizei)values.size(), &values.front()[0]);
+}
+
+UniformHandle Shader::GetUniformHandle(const std::string& name) const
+{
+	auto it = uniformLocations.find(name);
+	if (it == uniformLocations.end())
+	{
+		return UniformHandle();
+	}
+	return UniformHandle{ it->second };
+}
+
+void Shader::Set(UniformHandle handle, bool value) const
+{
+	glUniform1i(handle.location, (int)value);
+}
+
+void Shader::Set(UniformHandle handle, int value) const
+{
+	glUniform1i(handle.location, value);
+}
+
+void Shader::Set(UniformHandle handle, float value) const
+{
+	glUniform1f(handle.location, value);
+}
+
+void Shader::Set(UniformHandle handle, const glm::vec2& value) const
+{
+	glUniform2fv(handle.location, 1, &value[0]);
+}
+
+void Shader::Set(UniformHandle handle, const glm::vec3& value) const
+{
+	glUniform3fv(handle.location, 1, &value[0]);
+}
+
+void Shader::Set(UniformHandle handle, const glm::vec4& value) const
+{
+	glUniform4fv(handle.location, 1, &value[0]);
+}
+
+void Shader::Set(UniformHandle handle, const glm::mat2& mat) const
+{
+	glUniformMatrix2fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::Set(UniformHandle handle, const glm::mat3& mat) const
+{
+	glUniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::Set(UniformHandle handle, const glm::mat4& mat) const
+{
+	glUniformMatrix4fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::Set(UniformHandle handle, const std::vector<glm::mat4>& values) const
+{
+	if (!values.empty())
+	{
+		glUniformMatrix4fv(handle.location, (GLsizei)values.size(), GL_FALSE, &values.front()[0][0]);
+	}
+}
+
+void Shader::Set(UniformHandle handle, const std::vector<glm::vec3>& values) const
+{
+	if (!values.empty())
+	{
+		glUniform3fv(handle.location, (GLsizei)values.size(), &values.front()[0]);
+	}
+}
+
+unsigned int Shader::GetStringLookupCount()
+{
+	return nStringLookups;
+}
+
+void Shader::ResetStringLookupCount()
+{
+	nStringLookups = 0;
+}
+
+void Shader::ReflectUniforms()
+{
+	int nUniforms = 0;
+	int maxNameLength = 0;
+	glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORMS, &nUniforms);
+	glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<char> nameBuffer(std::max(maxNameLength, 1));
+	for (int i = 0; i < nUniforms; i++)
+	{
+		int size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(shaderProgram, (GLuint)i, (GLsizei)nameBuffer.size(), nullptr, &size, &type, nameBuffer.data());
+		std::string name = nameBuffer.data();
+
+		//Uniforms inside of uniform blocks don't have a location
+		int location = glGetUniformLocation(shaderProgram, name.c_str());
+		if (location < 0)
+		{
+			continue;
+		}
+		uniformLocations[name] = location;
+
+		//Arrays are reported as "name[0]", also store the base name and the locations of the other elements
+		const std::string arraySuffix = "[0]";
+		if (name.size() > arraySuffix.size() && name.compare(name.size() - arraySuffix.size(), arraySuffix.size(), arraySuffix) == 0)
+		{
+			std::string baseName = name.substr(0, name.size() - arraySuffix.size());
+			uniformLocations[baseName] = location;
+			for (int element = 1; element < size; element++)
+			{
+				std::string elementName = baseName + "[" + std::to_string(element) + "]";
+				uniformLocations[elementName] = glGetUniformLocation(shaderProgram, elementName.c_str());
+			}
+		}
+	}
+	GL_ERROR_CHECK();
+}
+
+void Shader::BindUniformBlocks()
+{
+	//Connect the shared uniform blocks used by this shader to their fixed binding points
+	for (unsigned int i = 0; i < (unsigned int)UniformBlock::Count; i++)
+	{
+		UniformBlock block = (UniformBlock)i;
+		unsigned int blockIndex = glGetUniformBlockIndex(shaderProgram, UniformBuffer::GetBlockName(block));
+		if (blockIndex != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(shaderProgram, blockIndex, i);
+		}
+	}
+	GL_ERROR_CHECK();
+}
+
+int Shader::FindUniformLocation(const std::string& name) const
+{
+	nStringLookups++;
+	auto it = uniformLocations.find(name);
+	if (it == uniformLocations.end())
+	{
+		return -1;
+	}
+	return it->second;
 }
 
 std::string Shader::FromFile(std::string path)
@@ -213,6 +439,34 @@ std::string Shader::FromFile(std::string path)
 	return content.str();
 }
 
+std::string Shader::InjectDefines(std::string code, const std::string& defines)
+{
+	//Turn "A;B 2" into "#define A\n#define B 2\n"
+	std::string defineLines;
+	std::stringstream defineStream(defines);
+	std::string define;
+	while (std::getline(defineStream, define, ';'))
+	{
+		if (!define.empty())
+		{
+			defineLines.append("#define ");
+			defineLines.append(define);
+			defineLines.append("\n");
+		}
+	}
+
+	//Defines have to come after the #version line
+	size_t versionPos = code.find("#version");
+	size_t insertPos = 0;
+	if (versionPos != std::string::npos)
+	{
+		insertPos = code.find('\n', versionPos);
+		insertPos = (insertPos == std::string::npos) ? code.size() : insertPos + 1;
+	}
+	code.insert(insertPos, defineLines);
+	return code;
+}
+
 unsigned int Shader::CreateShader(std::string name, const char* source, unsigned int type)
 {
 	//Create and compile shader
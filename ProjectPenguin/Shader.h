@@ -4,18 +4,33 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <memory>
+
+//Location of a uniform, resolve it once with Shader::GetUniformHandle and reuse it to skip the name lookup
+struct UniformHandle
+{
+	int location = -1;	//-1 if the uniform isn't used by the shader, setting it is silently ignored like in OpenGL
+};
 
 class Shader
 {
 public:
 	Shader(std::string vertexName, std::string fragmentName);
 	Shader(std::string vertexName, std::string fragmentName, std::string geometryName);
+	Shader(std::string vertexName, std::string fragmentName, std::string geometryName, std::string defines);
+	//Vertex shader only program whose outputs are captured with transform feedback, interleaved in the order given
+	Shader(std::string vertexName, const std::vector<std::string>& feedbackVaryings);
 	~Shader();
 	Shader(const Shader&) = delete;
 	Shader operator=(const Shader&) = delete;
 	Shader(Shader&& rhs) noexcept;
 	Shader operator=(Shader&& rhs) = delete;
 	
+	//Returns a program that is shared by everyone who asks for the same combination of files and defines.
+	//Defines are separated by semicolons, e.g. "MAX_LIGHTS 8;NO_SHADOWS"
+	static const Shader& GetShared(std::string vertexName, std::string fragmentName, std::string geometryName = "", std::string defines = "");
+
 	unsigned int Get() const;
 
 	void Use() const;
@@ -34,9 +49,39 @@ public:
 	void SetUniformMat4(const std::string& name, const glm::mat4& mat) const;
 	void SetUniformMat4Array(const std::string& name, const std::vector<glm::mat4>& values) const;
 	void SetUniformVec3Array(const std::string& name, const std::vector<glm::vec3>& values) const;
+
+	//Fast path, use these in code that runs every frame
+	UniformHandle GetUniformHandle(const std::string& name) const;
+	void Set(UniformHandle handle, bool value) const;
+	void Set(UniformHandle handle, int value) const;
+	void Set(UniformHandle handle, float value) const;
+	void Set(UniformHandle handle, const glm::vec2& value) const;
+	void Set(UniformHandle handle, const glm::vec3& value) const;
+	void Set(UniformHandle handle, const glm::vec4& value) const;
+	void Set(UniformHandle handle, const glm::mat2& mat) const;
+	void Set(UniformHandle handle, const glm::mat3& mat) const;
+	void Set(UniformHandle handle, const glm::mat4& mat) const;
+	void Set(UniformHandle handle, const std::vector<glm::mat4>& values) const;
+	void Set(UniformHandle handle, const std::vector<glm::vec3>& values) const;
+
+	//Debug counter of uniforms that were set by name, should stay at zero in a regular frame
+	static unsigned int GetStringLookupCount();
+	static void ResetStringLookupCount();
 private:
 	std::string FromFile(std::string path);
+	std::string InjectDefines(std::string code, const std::string& defines);
 	unsigned int CreateShader(std::string name, const char* source, unsigned int type);
+	void ReflectUniforms();
+	void BindUniformBlocks();
+	int FindUniformLocation(const std::string& name) const;
 private:
 	unsigned int shaderProgram = 0;
+
+	//Locations of all active uniforms, array elements are stored both as "name" and "name[i]"
+	std::unordered_map<std::string, int> uniformLocations;
+
+	static unsigned int nStringLookups;
+
+	//Programs handed out by GetShared, key is "vertex|fragment|geometry|defines"
+	static std::unordered_map<std::string, std::unique_ptr<Shader>> sharedShaders;
 };
\ No newline at end of file
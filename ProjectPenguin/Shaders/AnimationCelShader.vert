@@ -1,43 +1,30 @@
 #version 330 core
 
-const int MAX_JOINTS = 200;
-const int MAX_WEIGHTS = 4;
-
-layout (location = 0) in vec3 in_position;
-layout (location = 1) in vec3 in_normal;
 layout (location = 2) in vec2 in_texcoord;
-layout (location = 3) in ivec4 in_jointIndices;
-layout (location = 4) in vec4 in_weights;
+layout (location = 11) in int in_vertexOffset;	//Per instance, first vertex of this instance in skinnedVertices
 
 out vec3 position;
 out vec3 normal;
 out vec2 texcoord;
 
-uniform mat4 jointTransforms[MAX_JOINTS];
-uniform mat4 model;
-uniform mat4 mvp;
-
-void main()
+uniform samplerBuffer skinnedVertices;	//Written by Skinning.vert this frame, world space position and normal per vertex
+layout (std140) uniform FrameConstants
 {
-	//Animation is applied by taking weighted average of joints that affect this vertex
+	mat4 viewProjection;
+	vec3 cameraPos;
+};
 
-	//Local position after animation has been applied
-	vec4 totalLocalPos = vec4(0.0);
-	//Normal after animation has been applied
-	vec4 totalNormal = vec4(0.0);
-	
-	//Loop through weights to apply animation
-	for(int i = 0; i < MAX_WEIGHTS; i++)
-	{
-		vec4 localPosition = jointTransforms[in_jointIndices[i]] * vec4(in_position, 1.0);
-		totalLocalPos += localPosition * in_weights[i];
+//Must match the depth pre-pass exactly, the opaque pass tests for equal depth after it
+invariant gl_Position;
 
-		vec4 worldNormal = jointTransforms[in_jointIndices[i]] * vec4(in_normal, 0.0);
-		totalNormal += worldNormal * in_weights[i];
-	}
+void main()
+{
+	//The vertex has already been skinned, gl_VertexID is its index in the model
+	int texel = (in_vertexOffset + gl_VertexID) * 2;
+	vec4 worldPosition = texelFetch(skinnedVertices, texel);
 
-	gl_Position = mvp * totalLocalPos;
-	normal = (model * totalNormal).xyz;
-	position = vec3(model * totalLocalPos);
+	gl_Position = viewProjection * worldPosition;
+	normal = texelFetch(skinnedVertices, texel + 1).xyz;
+	position = vec3(worldPosition);
 	texcoord = in_texcoord;
 }
\ No newline at end of file
@@ -6,11 +6,13 @@ in vec3 normal;
 in vec2 texcoord;
 
 uniform sampler2D tex;
-uniform samplerCube shadowCubeMap;
-uniform samplerCube shadowCubeMapBaked;
+uniform samplerCubeShadow shadowCubeMap;	//Baked and dynamic shadows combined
 
-uniform float lightFarPlane;
-uniform vec3 lightPos;
+layout (std140) uniform LightConstants
+{
+	vec3 lightPos;
+	float lightFarPlane;
+};
 
 vec3 lightDir = normalize(lightPos - position);
 float lightDist = length(lightPos - position);
@@ -27,15 +29,15 @@ float Shadow()
 {
 	//Sample cube map
 	vec3 fromLight = position - lightPos;
-	float closestDepth = min(texture(shadowCubeMap, fromLight).r, texture(shadowCubeMapBaked, fromLight).r);
-	closestDepth *= lightFarPlane;
 	//Calculate current depth to compare
 	float currrentDepth = length(fromLight);
 	//Check if fragment is in Shadow
 	float minBias = 0.005;
 	float maxBias = 0.05;
 	float bias = max(maxBias * (1.0 - dot(normal, lightDir)), minBias);
-	return currrentDepth - bias > closestDepth ? 0.7 : 0.0;
+	//The comparison is done by the hardware, 1.0 means lit
+	float lit = texture(shadowCubeMap, vec4(fromLight, (currrentDepth - bias) / lightFarPlane));
+	return (1.0 - lit) * 0.7;
 }
 
 float Smooth()
@@ -7,8 +7,11 @@ in vec2 texcoord;
 
 uniform sampler2D tex;
 
-//uniform float lightFarPlane;
-uniform vec3 lightPos;
+layout (std140) uniform LightConstants
+{
+	vec3 lightPos;
+	float lightFarPlane;
+};
 
 vec3 lightDir = normalize(lightPos - position);
 
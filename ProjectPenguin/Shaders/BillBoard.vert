@@ -1,14 +0,0 @@
-#version 330 core
-layout (location = 0) in vec2 aPosition;
-layout (location = 1) in vec2 aTexCoord;
-
-out vec2 TexCoord;
-
-uniform mat4 model;
-uniform mat4 mvp;
-
-void main()
-{
-	gl_Position = mvp * vec4(aPosition, 0.0, 1.0);
-	TexCoord = aTexCoord;
-}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec2 corner;
+
+void main()
+{
+	if(dot(corner, corner) > 1.0)
+	{
+		discard;
+	}
+	FragColor = vec4(1.0);
+}
\ No newline at end of file
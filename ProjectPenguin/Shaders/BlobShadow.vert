@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec2 in_corner;
+layout (location = 1) in vec3 in_blob;	//Per instance: center on the xz plane and radius
+
+uniform vec4 area;	//Center and half size of the area on the xz plane
+
+out vec2 corner;
+
+void main()
+{
+	corner = in_corner;
+	vec2 worldPosition = in_blob.xy + in_corner * in_blob.z;
+	gl_Position = vec4((worldPosition - area.xy) / area.zw, 0.0, 1.0);
+}
\ No newline at end of file
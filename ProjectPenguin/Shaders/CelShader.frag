@@ -5,35 +5,51 @@ in vec3 position;
 in vec3 normal;
 in vec2 texcoord;
 
+#ifdef TEXTURE_ARRAY
+uniform sampler2DArray tex;
+flat in float layer;
+#else
 uniform sampler2D tex;
-uniform samplerCube shadowCubeMap;
-uniform samplerCube shadowCubeMapBaked;
+#endif
+uniform samplerCubeShadow shadowCubeMap;	//Baked and dynamic shadows combined
 
-uniform float lightFarPlane;
-uniform vec3 lightPos;
+layout (std140) uniform LightConstants
+{
+	vec3 lightPos;
+	float lightFarPlane;
+};
 
 vec3 lightDir = normalize(lightPos - position);
 
+vec4 BaseColor()
+{
+#ifdef TEXTURE_ARRAY
+	return texture(tex, vec3(texcoord, layer));
+#else
+	return texture(tex, texcoord);
+#endif
+}
+
 float glossiness = 32.0;
 
 vec4 Smooth()
 {
-	return texture(tex, texcoord) * max(dot(lightDir, normal), 0.0);
+	return BaseColor() * max(dot(lightDir, normal), 0.0);
 }
 
 float Shadow()
 {
 	//Sample cube map
 	vec3 fromLight = position - lightPos;
-	float closestDepth = min(texture(shadowCubeMap, fromLight).r, texture(shadowCubeMapBaked, fromLight).r);
-	closestDepth *= lightFarPlane;
 	//Calculate current depth to compare
 	float currentDepth = length(fromLight);
 	//Check if fragment is in Shadow
 	float minBias = 0.005;
 	float maxBias = 0.05;
 	float bias = max(maxBias * (1.0 - dot(normal, lightDir)), minBias);
-	return currentDepth - bias > closestDepth ? 0.3 : 0.0;
+	//The comparison is done by the hardware, 1.0 means lit
+	float lit = texture(shadowCubeMap, vec4(fromLight, (currentDepth - bias) / lightFarPlane));
+	return (1.0 - lit) * 0.3;
 }
 
 
@@ -48,5 +64,5 @@ float Cel()
 //REPLACE: hardcoded shadow brightness values (0.7 and 0.3)
 void main()
 {
-	FragColor = texture(tex, texcoord) * min(Cel(), 1 - Shadow());
+	FragColor = BaseColor() * min(Cel(), 1 - Shadow());
 }
\ No newline at end of file
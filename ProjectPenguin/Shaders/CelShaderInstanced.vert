@@ -0,0 +1,34 @@
+#version 330 core
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_normal;
+layout (location = 2) in vec2 in_texcoord;
+layout (location = 5) in mat4 in_model;	//Per instance, takes up locations 5 to 8
+#ifdef TEXTURE_ARRAY
+layout (location = 3) in float in_layer;	//Per instance, layer of the model's texture in its texture array
+flat out float layer;
+#endif
+
+out vec3 position;
+out vec3 normal;
+out vec2 texcoord;
+
+layout (std140) uniform FrameConstants
+{
+	mat4 viewProjection;
+	vec3 cameraPos;
+};
+
+//Must match the depth pre-pass exactly, the opaque pass tests for equal depth after it
+invariant gl_Position;
+
+void main()
+{
+	vec4 worldPosition = in_model * vec4(in_position, 1.0);
+	gl_Position = viewProjection * worldPosition;
+	normal = normalize(mat3(in_model) * in_normal);
+	position = vec3(worldPosition);
+	texcoord = in_texcoord;
+#ifdef TEXTURE_ARRAY
+	layer = in_layer;
+#endif
+}
\ No newline at end of file
@@ -2,12 +2,15 @@
 #version 330 core
 in vec4 position;
 
-uniform vec3 lightPos;
-uniform float farPlane;
+layout (std140) uniform LightConstants
+{
+	vec3 lightPos;
+	float lightFarPlane;
+};
 
 void main()
 {
 	float lightDistance = length(position.xyz - lightPos);
-	lightDistance = lightDistance / farPlane;
+	lightDistance = lightDistance / lightFarPlane;
 	gl_FragDepth = lightDistance;
 }
\ No newline at end of file
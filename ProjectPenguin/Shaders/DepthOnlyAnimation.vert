@@ -1,28 +1,15 @@
 #version 330 core
 
-const int MAX_JOINTS = 200;
-const int MAX_WEIGHTS = 4;
+layout (location = 10) in int in_faceMask;	//Per instance, cube map faces this instance overlaps
+layout (location = 11) in int in_vertexOffset;	//Per instance, first vertex of this instance in skinnedVertices
 
-//normals and texture coordinates not used
-layout (location = 0) in vec3 in_position;
-layout (location = 3) in ivec4 in_jointIndices;
-layout (location = 4) in vec4 in_weights;
+flat out int faceMask;
 
-uniform mat4 modelTransform;
-uniform mat4 jointTransforms[MAX_JOINTS];
+uniform samplerBuffer skinnedVertices;	//Written by Skinning.vert this frame, world space position and normal per vertex
 
 void main()
 {
-	//Animation is applied by taking weighted average of joints that affect this vertex
-
-	//Local position after animation has been applied
-	vec4 totalLocalPos = vec4(0.0);
-	
-	//Loop through weights to apply animation
-	for(int i = 0; i < MAX_WEIGHTS; i++)
-	{
-		vec4 localPosition = jointTransforms[in_jointIndices[i]] * vec4(in_position, 1.0);
-		totalLocalPos += localPosition * in_weights[i];
-	}
-	gl_Position = modelTransform * totalLocalPos;
+	//The vertex has already been skinned, gl_VertexID is its index in the model
+	gl_Position = texelFetch(skinnedVertices, (in_vertexOffset + gl_VertexID) * 2);
+	faceMask = in_faceMask;
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec3 in_position;
+layout (location = 5) in mat4 in_model;	//Per instance, takes up locations 5 to 8
+layout (location = 10) in int in_faceMask;	//Per instance, cube map faces this instance overlaps
+
+flat out int faceMask;
+
+void main()
+{
+	gl_Position = in_model * vec4(in_position, 1.0);
+	faceMask = in_faceMask;
+}
\ No newline at end of file
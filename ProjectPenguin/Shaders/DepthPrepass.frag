@@ -0,0 +1,6 @@
+#version 330 core
+
+//Colour writes are off during the pre-pass, only the depth test matters
+void main()
+{
+}
\ No newline at end of file
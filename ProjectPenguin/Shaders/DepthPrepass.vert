@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 in_position;
+layout (location = 5) in mat4 in_model;	//Per instance, takes up locations 5 to 8
+
+layout (std140) uniform FrameConstants
+{
+	mat4 viewProjection;
+	vec3 cameraPos;
+};
+
+//The opaque pass only draws fragments with exactly this depth, so it has to be calculated the same way in both
+invariant gl_Position;
+
+void main()
+{
+	vec4 worldPosition = in_model * vec4(in_position, 1.0);
+	gl_Position = viewProjection * worldPosition;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 330 core
+
+layout (location = 11) in int in_vertexOffset;	//Per instance, first vertex of this instance in skinnedVertices
+
+uniform samplerBuffer skinnedVertices;	//Written by Skinning.vert this frame, world space position and normal per vertex
+layout (std140) uniform FrameConstants
+{
+	mat4 viewProjection;
+	vec3 cameraPos;
+};
+
+//The opaque pass only draws fragments with exactly this depth, so it has to be calculated the same way in both
+invariant gl_Position;
+
+void main()
+{
+	//The vertex has already been skinned, gl_VertexID is its index in the model
+	vec4 worldPosition = texelFetch(skinnedVertices, (in_vertexOffset + gl_VertexID) * 2);
+	gl_Position = viewProjection * worldPosition;
+}
\ No newline at end of file
@@ -4,10 +4,11 @@ out vec4 FragColor;
 in vec2 TexCoord;
 
 uniform sampler2D texture0;
+uniform vec2 maxTexcoord;	//Stay inside the part of the texture the scene covers
 
 uniform float brightness;
 
 void main()
 {
-	FragColor = min(vec4(1.0), vec4(brightness) + texture(texture0, TexCoord));
+	FragColor = min(vec4(1.0), vec4(brightness) + texture(texture0, min(TexCoord, maxTexcoord)));
 }
\ No newline at end of file
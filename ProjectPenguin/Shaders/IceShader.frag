@@ -1,51 +1,59 @@
 #version 330 core
 
-const int MAX_COLLECTIBLES = 20;
-const float MAX_COLLECTIBLE_HEIGHT = 10.0;
-
 out vec4 FragColor;
 
 in vec3 position;
 in vec3 normal;
 in vec2 texcoord;
 
+#ifdef TEXTURE_ARRAY
+uniform sampler2DArray tex;
+flat in float layer;
+#else
 uniform sampler2D tex;
-uniform samplerCube shadowCubeMap;
-uniform samplerCube shadowCubeMapBaked;
+#endif
+uniform samplerCubeShadow shadowCubeMap;	//Baked and dynamic shadows combined
 
-uniform float lightFarPlane;
-uniform vec3 lightPos;
+layout (std140) uniform LightConstants
+{
+	vec3 lightPos;
+	float lightFarPlane;
+};
 
-uniform int nCollectibles;
-uniform vec3 collectibles[MAX_COLLECTIBLES];
+//Shadows of collectibles, drawn top-down by BlobShadows
+uniform sampler2D blobShadows;
+uniform vec4 blobShadowArea;
 
 vec3 lightDir = normalize(lightPos - position);
 
+vec4 BaseColor()
+{
+#ifdef TEXTURE_ARRAY
+	return texture(tex, vec3(texcoord, layer));
+#else
+	return texture(tex, texcoord);
+#endif
+}
+
 float Shadow()
 {
 	//Render collectible shadows
-	for(int i = 0; i < nCollectibles; i++)
+	if(texture(blobShadows, (position.xz - blobShadowArea.xy) / blobShadowArea.zw + 0.5).r > 0.5)
 	{
-		
-		float radius = (MAX_COLLECTIBLE_HEIGHT - collectibles[i].y) / MAX_COLLECTIBLE_HEIGHT * 0.3;
-		if(distance(position.xz, collectibles[i].xz) < radius)
-		{
-			
-			return 0.3;
-		}
-	}	
+		return 0.3;
+	}
 
 	//Sample cube map
 	vec3 fromLight = position - lightPos;
-	float closestDepth = min(texture(shadowCubeMap, fromLight).r, texture(shadowCubeMapBaked, fromLight).r);
-	closestDepth *= lightFarPlane;
 	//Calculate current depth to compare
 	float currrentDepth = length(fromLight);
 	//Check if fragment is in Shadow
 	float minBias = 0.005;
 	float maxBias = 0.05;
 	float bias = max(maxBias * (1.0 - dot(normal, lightDir)), minBias);
-	return currrentDepth - bias > closestDepth ? 0.3 : 0.0;
+	//The comparison is done by the hardware, 1.0 means lit
+	float lit = texture(shadowCubeMap, vec4(fromLight, (currrentDepth - bias) / lightFarPlane));
+	return (1.0 - lit) * 0.3;
 }
 
 float Smooth()
@@ -55,5 +63,5 @@ float Smooth()
 
 void main()
 {
-	FragColor = texture(tex, texcoord) * min(Smooth(), 1 - Shadow());
+	FragColor = BaseColor() * min(Smooth(), 1 - Shadow());
 }
\ No newline at end of file
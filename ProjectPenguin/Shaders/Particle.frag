@@ -0,0 +1,16 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texcoord;
+
+uniform sampler2D texture0;
+
+void main()
+{
+	vec4 color = texture(texture0, texcoord);
+	if(color.w <= 0.0)
+	{
+		discard;
+	}
+	FragColor = color;
+}
\ No newline at end of file
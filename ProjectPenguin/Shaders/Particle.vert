@@ -0,0 +1,52 @@
+#version 330 core
+layout (location = 0) in vec2 in_corner;	//Corner of the quad, from -1 to 1
+layout (location = 1) in vec2 in_texcoord;
+layout (location = 2) in vec3 in_spawnPosition;	//Per instance
+layout (location = 3) in float in_spawnTime;	//Per instance
+layout (location = 4) in int in_type;	//Per instance, see ParticleType
+
+out vec2 texcoord;
+
+layout (std140) uniform FrameConstants
+{
+	mat4 viewProjection;
+	vec3 cameraPos;
+};
+
+uniform float time;	//Clock of the particle system that spawned the particles
+
+//Smoke, a flipbook with its frames side by side that always faces the camera
+const int smokeType = 0;
+const int smokeFrames = 9;
+const float smokeTimePerFrame = 0.075;
+const float smokeSize = 1.0;
+
+//+5, rises while tilted back 45 degrees
+const float plus5Size = 0.2;
+const float plus5Speed = 2.0;
+
+void main()
+{
+	float age = time - in_spawnTime;
+
+	vec3 position;
+	if (in_type == smokeType)
+	{
+		vec3 toCamera = normalize(cameraPos - in_spawnPosition);
+		vec3 right = normalize(cross(vec3(0.0, 1.0, 0.0), toCamera));
+		vec3 up = cross(toCamera, right);
+		position = in_spawnPosition + (right * in_corner.x + up * in_corner.y) * smokeSize;
+
+		int frame = min(int(age / smokeTimePerFrame), smokeFrames - 1);
+		texcoord = vec2((in_texcoord.x + float(frame)) / float(smokeFrames), in_texcoord.y);
+	}
+	else
+	{
+		const vec3 right = vec3(1.0, 0.0, 0.0);
+		const vec3 up = vec3(0.0, 0.70710678, -0.70710678);
+		position = in_spawnPosition + vec3(0.0, plus5Speed * age, 0.0) + (right * in_corner.x + up * in_corner.y) * plus5Size;
+		texcoord = in_texcoord;
+	}
+
+	gl_Position = viewProjection * vec4(position, 1.0);
+}
\ No newline at end of file
@@ -4,8 +4,10 @@ layout (location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
 
+uniform vec2 texcoordScale;	//The scene may only cover part of the texture
+
 void main()
 {
     gl_Position = vec4(aPos, 0.1, 1.0);
-    TexCoord = aTexCoord;
+    TexCoord = aTexCoord * texcoordScale;
 }
\ No newline at end of file
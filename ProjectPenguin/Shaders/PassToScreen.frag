@@ -4,8 +4,9 @@ out vec4 FragColor;
 in vec2 TexCoord;
 
 uniform sampler2D texture0;
+uniform vec2 maxTexcoord;	//Stay inside the part of the texture the scene covers
 
 void main()
 {
-	FragColor = texture(texture0, TexCoord);
+	FragColor = texture(texture0, min(TexCoord, maxTexcoord));
 }
\ No newline at end of file
@@ -1,18 +0,0 @@
-#version 330 core
-out vec4 FragColor;
-
-in vec2 TexCoord;
-
-uniform sampler2D texture0;
-
-void main()
-{
-    vec4 texColor = texture(texture0, TexCoord);
-
-	if(texColor.a == 0.0)
-	{
-		discard;
-	}
-
-    FragColor = texColor;
-}
\ No newline at end of file
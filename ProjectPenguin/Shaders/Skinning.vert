@@ -0,0 +1,52 @@
+#version 330 core
+
+const int MAX_WEIGHTS = 4;
+
+//Runs once per vertex per instance with rasterization disabled, texture coordinates aren't needed
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_normal;
+layout (location = 3) in ivec4 in_jointIndices;
+layout (location = 4) in vec4 in_weights;
+layout (location = 5) in mat4 in_model;	//Per instance, takes up locations 5 to 8
+layout (location = 9) in int in_paletteOffset;	//Per instance, first joint transform of this instance in jointPalette
+
+//Captured with transform feedback, every vertex ends up as 2 texels of skinnedVertices
+out vec4 skinnedPosition;
+out vec4 skinnedNormal;
+
+uniform samplerBuffer jointPalette;	//Joint transforms of every instance drawn this frame, 4 texels per matrix
+
+mat4 GetJointTransform(int jointIndex)
+{
+	int texel = (in_paletteOffset + jointIndex) * 4;
+	return mat4(texelFetch(jointPalette, texel),
+		texelFetch(jointPalette, texel + 1),
+		texelFetch(jointPalette, texel + 2),
+		texelFetch(jointPalette, texel + 3));
+}
+
+void main()
+{
+	//Animation is applied by taking weighted average of joints that affect this vertex
+
+	//Local position after animation has been applied
+	vec4 totalLocalPos = vec4(0.0);
+	//Normal after animation has been applied
+	vec4 totalNormal = vec4(0.0);
+	
+	//Loop through weights to apply animation
+	for(int i = 0; i < MAX_WEIGHTS; i++)
+	{
+		mat4 jointTransform = GetJointTransform(in_jointIndices[i]);
+
+		vec4 localPosition = jointTransform * vec4(in_position, 1.0);
+		totalLocalPos += localPosition * in_weights[i];
+
+		vec4 worldNormal = jointTransform * vec4(in_normal, 0.0);
+		totalNormal += worldNormal * in_weights[i];
+	}
+
+	//Stored in world space, so the passes that draw it don't need the model matrix
+	skinnedPosition = in_model * totalLocalPos;
+	skinnedNormal = vec4((in_model * totalNormal).xyz, 0.0);
+}
\ No newline at end of file
@@ -1,6 +1,6 @@
 #version 330 core
 
-const int MAX_LIGHTS = 15;
+#define MAX_SIMPLE_LIGHTS 64
 
 out vec4 FragColor;
 
@@ -8,15 +8,39 @@ in vec3 position;
 in vec3 normal;
 in vec2 texcoord;
 
+#ifdef TEXTURE_ARRAY
+uniform sampler2DArray tex;
+flat in float layer;
+#else
 uniform sampler2D tex;
-uniform samplerCube shadowCubeMap;
-uniform samplerCube shadowCubeMapBaked;
+#endif
+uniform samplerCubeShadow shadowCubeMap;	//Baked and dynamic shadows combined
+#ifdef LIGHTMAP
+//The fixed simple lights, baked by Lightmap
+uniform sampler2DArray lightmap;
+in vec3 lightmapTexcoord;
+const float maxLightmapIntensity = 2.0;
+#endif
 
-uniform float lightFarPlane;
-uniform vec3 lightPos;
+layout (std140) uniform LightConstants
+{
+	vec3 lightPos;
+	float lightFarPlane;
+};
 
-uniform vec3[MAX_LIGHTS] simpleLights;
-uniform int nSimpleLights;
+//Filled by LightClusters every frame
+layout (std140) uniform SimpleLights
+{
+	vec4 simpleLights[MAX_SIMPLE_LIGHTS];
+	vec3 clusterGridMin;
+	float clusterSize;
+	ivec3 clusterGridSize;
+	int nSimpleLights;
+	float simpleLightRadius;
+	int nBakedLights;
+};
+//One texel per cell with the offset and count of its lights, followed by the light indices in x
+uniform isamplerBuffer lightClusters;
 
 vec3 lightDir = normalize(lightPos - position);
 float lightDist = length(lightPos - position);
@@ -24,7 +48,6 @@ float lightDist = length(lightPos - position);
 float lightGradientRadius = 5.0;
 const float ambient = 0.3;
 
-const float simpleLightRadius = 3.0f;
 const vec3 simpleLightColor = vec3(1.0, 0.8, 0.6);
 
 //IceRink properties
@@ -36,15 +59,15 @@ float Shadow()
 {
 	//Sample cube map
 	vec3 fromLight = position - lightPos;
-	float closestDepth = min(texture(shadowCubeMap, fromLight).r, texture(shadowCubeMapBaked, fromLight).r);
-	closestDepth *= lightFarPlane;
 	//Calculate current depth to compare
 	float currrentDepth = length(fromLight);
 	//Check if fragment is in Shadow
 	float minBias = 0.005;
 	float maxBias = 0.05;
 	float bias = max(maxBias * (1.0 - dot(normal, lightDir)), minBias);
-	return currrentDepth - bias > closestDepth ? 0.7 : 0.0;
+	//The comparison is done by the hardware, 1.0 means lit
+	float lit = texture(shadowCubeMap, vec4(fromLight, (currrentDepth - bias) / lightFarPlane));
+	return (1.0 - lit) * 0.7;
 }
 
 vec3 Smooth()
@@ -65,13 +88,30 @@ vec3 Smooth()
 		distanceMultiplier = 1.0 - (distanceToCorner - cornerRadius) / lightGradientRadius;
 	}
 
-	//From simple light
+	//From simple lights, only the ones that can reach this fragment's cell
 	vec3 fromSimpleLights = vec3(0);
-	for(int i = 0; i < nSimpleLights; i++)
+	int firstLight = 0;
+#ifdef LIGHTMAP
+	//The fixed lights come from the lightmap, only the moving ones are left
+	fromSimpleLights = texture(lightmap, lightmapTexcoord).r * maxLightmapIntensity * simpleLightColor;
+	firstLight = nBakedLights;
+#endif
+	ivec3 cell = ivec3(floor((position - clusterGridMin) / clusterSize));
+	if(all(greaterThanEqual(cell, ivec3(0))) && all(lessThan(cell, clusterGridSize)))
 	{
-		fromSimpleLights += clamp((simpleLightRadius - distance(position, simpleLights[i])) / simpleLightRadius, 0.0, 1.0)
-			* max(dot(simpleLights[i] - position, normal), 0.0)
-			* simpleLightColor;
+		ivec2 range = texelFetch(lightClusters, cell.x + clusterGridSize.x * (cell.y + clusterGridSize.y * cell.z)).xy;
+		for(int i = range.x; i < range.x + range.y; i++)
+		{
+			int lightIndex = texelFetch(lightClusters, i).x;
+			if(lightIndex < firstLight)
+			{
+				continue;
+			}
+			vec3 simpleLight = simpleLights[lightIndex].xyz;
+			fromSimpleLights += clamp((simpleLightRadius - distance(position, simpleLight)) / simpleLightRadius, 0.0, 1.0)
+				* max(dot(simpleLight - position, normal), 0.0)
+				* simpleLightColor;
+		}
 	}
 
 	return vec3(1) * min(max(dot(lightDir, normal), 0.0) * clamp(distanceMultiplier, ambient, 1.0), 1 - Shadow()) + fromSimpleLights;
@@ -79,21 +119,12 @@ vec3 Smooth()
 
 void main()
 {
+#ifdef TEXTURE_ARRAY
+	vec4 textureColor = texture(tex, vec3(texcoord, layer));
+#else
 	vec4 textureColor = texture(tex, texcoord);
-	if(all(lessThan(vec3(-0.001, 0.811, 0.949), textureColor.rgb)) && all(lessThan(textureColor.rgb, vec3(0.001, 0.812, 0.951))))
-	{
-		FragColor = vec4(1.0, 0.8, 0.5, 1.0);
-	}
-	else if(all(lessThan(vec3(-0.001, 0.999, 0.222), textureColor.rgb)) && all(lessThan(textureColor.rgb, vec3(0.001, 1.001, 0.224))))
-	{
-		FragColor = vec4(0.7, 1.0, 0.7, 1.0);
-	}
-	else if(all(lessThan(vec3(0.006, -0.001, 0.999), textureColor.rgb)) && all(lessThan(textureColor.rgb, vec3(0.008, 0.001, 1.001))))
-	{
-		FragColor = vec4(1.0, 0.7, 0.7, 1.0);
-	}
-	else
-	{
-		FragColor = textureColor * vec4(Smooth(), 1);
-	}
+#endif
+	//Windows and lamps were marked by TextureBuilder, they hold the colour they glow with and alpha is how much a texel doesn't glow
+	float glow = 1.0 - textureColor.a;
+	FragColor = vec4(mix(textureColor.rgb * Smooth(), textureColor.rgb, glow), 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texcoord;
+in vec3 color;
+
+uniform sampler2D texture0;
+
+void main()
+{
+	vec4 texColor = texture(texture0, texcoord);
+	if(texColor.a == 0.0)
+	{
+		discard;
+	}
+
+	FragColor = vec4(texColor.rgb * color, texColor.a);
+}
\ No newline at end of file
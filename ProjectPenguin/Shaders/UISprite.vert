@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec2 in_position;
+layout (location = 1) in vec2 in_texcoord;	//In the UI atlas
+layout (location = 2) in vec3 in_color;
+
+out vec2 texcoord;
+out vec3 color;
+
+void main()
+{
+	gl_Position = vec4(in_position, 0.0, 1.0);
+	texcoord = in_texcoord;
+	color = in_color;
+}
\ No newline at end of file
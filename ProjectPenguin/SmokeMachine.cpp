@@ -1,43 +1,28 @@
 #include "SmokeMachine.h"
 
 SmokeMachine::SmokeMachine()
+	:
+	smokeEffects(ParticleType::Smoke, "UI/Clouds.png", maxSmokes)
 {
-	SmokeEffect::PreLoad();
 }
 
 void SmokeMachine::SpawnSmoke(glm::vec3 pos)
 {
-	smokeEffects.emplace_back(glm::vec3(pos.x, 1.0f, pos.z));
+	smokeEffects.Spawn(glm::vec3(pos.x, 1.0f, pos.z));
 }
 
 void SmokeMachine::Update(float deltaTime)
 {
-	//Update smokes
-	for (SmokeEffect& smoke : smokeEffects)
-	{
-		smoke.Update(deltaTime);
-	}
-	//Remove redundant smokes
-	{
-		const auto newEnd = std::remove_if(smokeEffects.begin(), smokeEffects.end(),
-			[](SmokeEffect& smoke)
-			{
-				return smoke.IsFinished();
-			});
-		smokeEffects.erase(newEnd, smokeEffects.end());
-	}
+	//Finished smokes are removed by the particle system
+	smokeEffects.Update(deltaTime);
 }
 
-void SmokeMachine::Draw(const Camera& camera)
+void SmokeMachine::Draw(StreamBuffer& streamBuffer)
 {
-	SmokeEffect::BindGraphics();
-	for (SmokeEffect& smoke : smokeEffects)
-	{
-		smoke.Draw(camera);
-	}
+	smokeEffects.Draw(streamBuffer);
 }
 
 void SmokeMachine::Clear()
 {
-	smokeEffects.clear();
-}
+	smokeEffects.Clear();
+}
\ No newline at end of file
@@ -1,8 +1,6 @@
 #pragma once
 
-#include "SmokeEffect.h"
-
-class Camera;
+#include "ParticleSystem.h"
 
 //This class handles spawning and destroying the smoke particle effect
 
@@ -12,8 +10,9 @@ public:
 	SmokeMachine();
 	void SpawnSmoke(glm::vec3 pos);
 	void Update(float deltaTime);
-	void Draw(const Camera& camera);
+	void Draw(StreamBuffer& streamBuffer);
 	void Clear();
 private:
-	std::vector<SmokeEffect> smokeEffects;
+	static constexpr size_t maxSmokes = 64;
+	ParticleSystem smokeEffects;
 };
\ No newline at end of file
@@ -0,0 +1,460 @@
+#include "StaticBatch.h"
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "Camera.h"
+#include "GLTFData.h"
+#include "GlGetError.h"
+#include "GlState.h"
+
+//Static members
+std::unordered_map<std::string, StaticBatch::BatchData> StaticBatch::existingBatches;
+std::vector<StaticBatch::InstanceData> StaticBatch::shadowCasters;
+const Shader* StaticBatch::depthPrepassShader = nullptr;
+unsigned int StaticBatch::lightmapArray = 0;
+
+StaticBatch::StaticBatch(std::string name, const glm::mat4& ownerTransform, const std::vector<Part>& parts, const Lightmap::Lights& bakedLights)
+	:
+	ownerTransform(ownerTransform),
+	batchData(ConstructBatchData(name, parts, bakedLights))
+{
+	std::cout << "Created static batch " << '\"' << name << '\"' << " from " << parts.size() << " models in " << batchData.groups.size() << " draw calls" << std::endl;
+}
+
+void StaticBatch::AddToRenderQueue(Camera& camera)
+{
+	batchData.renderQueue.push_back({ ownerTransform });
+
+	//Groups are only drawn when at least one instance can see them
+	for (Group& group : batchData.groups)
+	{
+		group.visible = group.visible || camera.IsInView(EliMath::TransformSphere(group.boundingSphere, ownerTransform));
+	}
+}
+
+void StaticBatch::SubmitInstances(RenderQueue& renderQueue, StreamBuffer& streamBuffer)
+{
+	for (std::pair<const std::string, BatchData>& element : existingBatches)
+	{
+		BatchData& batch = element.second;
+
+		if (!batch.renderQueue.empty())
+		{
+			UploadInstances(batch, batch.renderQueue, streamBuffer);
+			for (Group& group : batch.groups)
+			{
+				if (!group.visible)
+				{
+					continue;
+				}
+
+				float nearest = std::numeric_limits<float>::max();
+				for (const InstanceData& instance : batch.renderQueue)
+				{
+					EliMath::BoundingSphere sphere = EliMath::TransformSphere(group.boundingSphere, instance.modelTransform);
+					nearest = std::min(nearest, std::max(glm::distance(renderQueue.GetViewPos(), sphere.center) - sphere.radius, 0.0f));
+				}
+
+				DrawOptions options;
+				options.textureArray = true;
+				options.uintIndices = true;
+				options.firstIndex = group.firstIndex;
+				renderQueue.SubmitOpaque(*group.shader, *depthPrepassShader, group.textureArray, batch.vao, group.nIndices, batch.renderQueue.size(), nearest,
+					options);
+			}
+		}
+
+		//Clear renderqueue
+		batch.renderQueue.clear();
+		for (Group& group : batch.groups)
+		{
+			group.visible = false;
+		}
+	}
+	GL_ERROR_CHECK();
+}
+
+void StaticBatch::SubmitShadowCasters(RenderQueue& renderQueue, Light& light, StreamBuffer& streamBuffer)
+{
+	for (std::pair<const std::string, BatchData>& element : existingBatches)
+	{
+		BatchData& batch = element.second;
+
+		uint64_t batchHash = EliMath::HashBytes(element.first.data(), element.first.size(), batch.geometryHash);
+		shadowCasters.clear();
+		for (const InstanceData& instance : batch.renderQueue)
+		{
+			//The whole batch is drawn at once, so its face mask covers every group
+			int faceMask = light.GetFaceMask(EliMath::TransformSphere(batch.boundingSphere, instance.modelTransform));
+			if (faceMask != 0)
+			{
+				shadowCasters.push_back({ instance.modelTransform, faceMask });
+				light.AddShadowCaster(faceMask, EliMath::HashBytes(&instance.modelTransform, sizeof(glm::mat4), batchHash));
+			}
+		}
+		if (shadowCasters.empty())
+		{
+			continue;
+		}
+
+		//The depth shader doesn't need textures, so the whole batch is drawn at once
+		DrawOptions options;
+		options.uintIndices = true;
+		UploadInstances(batch, shadowCasters, streamBuffer);
+		renderQueue.Submit(RenderPass::Shadow, light.GetNonAnimationShader(), 0, batch.vao, batch.nIndices, shadowCasters.size(), 0.0f, options);
+	}
+	GL_ERROR_CHECK();
+}
+
+std::vector<const Shader*> StaticBatch::GetShaders() const
+{
+	std::vector<const Shader*> result;
+	for (const Group& group : batchData.groups)
+	{
+		if (std::find(result.begin(), result.end(), group.shader) == result.end())
+		{
+			result.push_back(group.shader);
+		}
+	}
+	return result;
+}
+
+void StaticBatch::BakeLightmaps(const std::vector<Part>& parts, const Lightmap::Lights& bakedLights)
+{
+	for (const Part& part : parts)
+	{
+		if (part.lightmapped)
+		{
+			tinygltf::Model data = LoadModel(part.modelName);
+			Lightmap::Mesh mesh = ReadMesh(data, part.modelName);
+			Lightmap::Get(mesh, Lightmap::Unwrap(mesh, bakedLights), bakedLights, part.modelName, true);
+		}
+	}
+}
+
+StaticBatch::BatchData& StaticBatch::ConstructBatchData(std::string name, const std::vector<Part>& parts, const Lightmap::Lights& bakedLights)
+{
+	//Check if batch has been previously built
+	if (existingBatches.count(name) == 0)
+	{
+		//-------------------------Step 0: Add batch data-------------------------------------------------
+		auto& newBatchData = existingBatches[name];
+
+		//-------------------------Step 1: Load all models, add their textures to the pool and sort them into groups-------------------------------------------------
+		//The arrays are shared with every other model, parts only need to remember their layer
+		std::vector<tinygltf::Model> models;
+		std::vector<std::vector<size_t>> partsPerGroup;
+		std::vector<float> layerPerPart(parts.size());
+		for (const Part& part : parts)
+		{
+			models.push_back(LoadModel(part.modelName));
+			tinygltf::Model& data = models.back();
+
+			std::string defines = TextureArrayPool::defines;
+			if (part.lightmapped)
+			{
+				defines.append(";LIGHTMAP");
+			}
+			const Shader* shader = &Shader::GetShared(part.vertexShader, part.fragShader, "", defines);
+
+			if (data.materials.empty() || data.textures.empty())
+			{
+				std::string errorMessage;
+				errorMessage.append("The model \"");
+				errorMessage.append(part.modelName);
+				errorMessage.append("\" could not be batched, because it doesn't have any textures");
+				throw std::exception(errorMessage.c_str());
+			}
+			const tinygltf::Material& material = data.materials[data.meshes[0].primitives[0].material];
+			const tinygltf::Image& image = data.images[data.textures[material.pbrMetallicRoughness.baseColorTexture.index].source];
+			TextureArrayPool::Layer layer = TextureArrayPool::Add(image, part.modelName, TextureArrayPool::UsesEmissiveKeys(part.fragShader));
+			layerPerPart[models.size() - 1] = layer.layer;
+
+			//Parts with the same shader and texture array end up in the same draw call.
+			//Every texture size and format gets its own array, so this can't be decided by the texture size alone
+			auto group = std::find_if(newBatchData.groups.begin(), newBatchData.groups.end(),
+				[shader, &layer](const Group& g) { return g.shader == shader && g.textureArray == layer.textureArray; });
+			if (group == newBatchData.groups.end())
+			{
+				newBatchData.groups.emplace_back();
+				newBatchData.groups.back().shader = shader;
+				newBatchData.groups.back().textureArray = layer.textureArray;
+				partsPerGroup.emplace_back();
+				group = newBatchData.groups.end() - 1;
+			}
+			partsPerGroup[group - newBatchData.groups.begin()].push_back(models.size() - 1);
+		}
+
+		//-------------------------Step 2: Merge the geometry of every group-------------------------------------------------
+		std::vector<Vertex> vertices;
+		std::vector<unsigned int> indices;
+		std::vector<std::vector<unsigned char>> lightmaps;	//One per lightmapped part
+		EliMath::AABB batchBounds;
+		for (size_t groupIndex = 0; groupIndex < newBatchData.groups.size(); groupIndex++)
+		{
+			Group& group = newBatchData.groups[groupIndex];
+			group.firstIndex = (unsigned int)indices.size();
+
+			for (size_t partIndex : partsPerGroup[groupIndex])
+			{
+				tinygltf::Model& data = models[partIndex];
+				const tinygltf::Primitive& primitiveData = data.meshes[0].primitives[0];
+				Lightmap::Mesh mesh = ReadMesh(data, parts[partIndex].modelName);
+				uint64_t partHash = EliMath::HashBytes(mesh.positions.data(), mesh.positions.size() * sizeof(glm::vec3));
+				partHash = EliMath::HashBytes(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int), partHash);
+				newBatchData.geometryHash = EliMath::HashBytes(&partHash, sizeof(partHash), newBatchData.geometryHash);
+				if (primitiveData.attributes.count("TEXCOORD_0") == 0
+					|| data.accessors[primitiveData.attributes.at("TEXCOORD_0")].componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+				{
+					std::string errorMessage;
+					errorMessage.append("The model \"");
+					errorMessage.append(parts[partIndex].modelName);
+					errorMessage.append("\" could not be batched, it needs float texture coordinates");
+					throw std::exception(errorMessage.c_str());
+				}
+				GLTFData texcoords(data, data.accessors[primitiveData.attributes.at("TEXCOORD_0")]);
+
+				//Lightmapped parts get a copy of every vertex for each triangle that uses it, the others are copied as they are
+				Lightmap::Unwrapped unwrapped;
+				float lightmapLayer = (float)lightmaps.size();
+				if (parts[partIndex].lightmapped)
+				{
+					unwrapped = Lightmap::Unwrap(mesh, bakedLights);
+					lightmaps.push_back(Lightmap::Get(mesh, unwrapped, bakedLights, parts[partIndex].modelName));
+				}
+				else
+				{
+					unwrapped.vertexRemap.resize(mesh.positions.size());
+					std::iota(unwrapped.vertexRemap.begin(), unwrapped.vertexRemap.end(), 0u);
+					unwrapped.indices = mesh.indices;
+				}
+
+				//Indices of this part start after the vertices of all previous parts
+				unsigned int baseVertex = (unsigned int)vertices.size();
+				for (size_t i = 0; i < unwrapped.vertexRemap.size(); i++)
+				{
+					unsigned int source = unwrapped.vertexRemap[i];
+					Vertex vertex;
+					vertex.position = mesh.positions[source];
+					vertex.normal = mesh.normals[source];
+					vertex.texcoord = *texcoords.GetElement<glm::vec2>(source);
+					vertex.layer = layerPerPart[partIndex];
+					if (parts[partIndex].lightmapped)
+					{
+						vertex.lightmapTexcoord = glm::vec3(unwrapped.texcoords[i], lightmapLayer);
+					}
+					vertices.push_back(vertex);
+					group.bounds.Grow(vertex.position);
+				}
+				for (unsigned int index : unwrapped.indices)
+				{
+					indices.push_back(baseVertex + index);
+				}
+			}
+
+			group.nIndices = indices.size() - group.firstIndex;
+			group.boundingSphere = EliMath::SphereFromAABB(group.bounds);
+			batchBounds.Grow(group.bounds);
+		}
+		newBatchData.nIndices = indices.size();
+		newBatchData.boundingSphere = EliMath::SphereFromAABB(batchBounds);
+
+		//-------------------------Step 3: Set up vao,vbo,ebo and set up vertex attrib pointers-------------------------------------------------
+		glGenVertexArrays(1, &newBatchData.vao);
+		GlState::BindVertexArray(newBatchData.vao);
+
+		unsigned int vbo;
+		glGenBuffers(1, &vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+
+		unsigned int ebo;
+		glGenBuffers(1, &ebo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texcoord));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(layerAttribLocation, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, layer));
+		glEnableVertexAttribArray(layerAttribLocation);
+		glVertexAttribPointer(lightmapAttribLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, lightmapTexcoord));
+		glEnableVertexAttribArray(lightmapAttribLocation);
+
+		//Set up per instance model matrix, the attributes are pointed at the stream buffer whenever the render queue is uploaded
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			glEnableVertexAttribArray(instanceAttribLocation + i);
+			glVertexAttribDivisor(instanceAttribLocation + i, 1);
+		}
+		glEnableVertexAttribArray(faceMaskAttribLocation);
+		glVertexAttribDivisor(faceMaskAttribLocation, 1);
+		GlState::BindVertexArray(0);
+
+		//-------------------------Step 4: Upload the lightmaps-------------------------------------------------
+		if (!lightmaps.empty())
+		{
+			if (lightmapArray != 0)
+			{
+				std::string errorMessage;
+				errorMessage.append("The static batch \"");
+				errorMessage.append(name);
+				errorMessage.append("\" has lightmaps, but another batch already has them");
+				throw std::exception(errorMessage.c_str());
+			}
+
+			glGenTextures(1, &lightmapArray);
+			GlState::ActiveTexture(lightmapTextureUnit);
+			GlState::BindTexture(GL_TEXTURE_2D_ARRAY, lightmapArray);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, Lightmap::resolution, Lightmap::resolution, (GLsizei)lightmaps.size(), 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+			for (size_t i = 0; i < lightmaps.size(); i++)
+			{
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, (GLint)i, Lightmap::resolution, Lightmap::resolution, 1, GL_RED, GL_UNSIGNED_BYTE, lightmaps[i].data());
+			}
+			//Stays bound, nothing else uses this unit
+			GlState::ActiveTexture(0);
+		}
+
+		//-------------------------Step 5: Set up the shaders-------------------------------------------------
+		//Texture units never change, so samplers only need to be set once per program
+		for (const Group& group : newBatchData.groups)
+		{
+			group.shader->Use();
+			group.shader->SetUniformInt("tex", 0);
+			group.shader->SetUniformInt("shadowCubeMap", 1);
+			group.shader->SetUniformInt("lightmap", lightmapTextureUnit);
+		}
+		if (!depthPrepassShader)
+		{
+			depthPrepassShader = &Shader::GetShared("DepthPrepass.vert", "DepthPrepass.frag");
+		}
+
+		GL_ERROR_CHECK();
+	}
+
+	return existingBatches.at(name);
+}
+
+tinygltf::Model StaticBatch::LoadModel(std::string name)
+{
+	//Import the model and check errors
+	tinygltf::TinyGLTF loader;
+	tinygltf::Model data;
+	std::string err;
+	std::string warn;
+	std::string path = "Models/";
+	path.append(name);
+	loader.LoadASCIIFromFile(&data, &err, &warn, path);
+
+	if (!err.empty())
+	{
+		std::string errorMessage = "Failed to load model: ";
+		errorMessage.append(name);
+		errorMessage.append("\n\n");
+		errorMessage.append("Received the following error(s): ");
+		errorMessage.append(err);
+		throw std::invalid_argument(errorMessage.c_str());
+	}
+	if (!warn.empty())
+	{
+		std::string errorMessage = "Failed to load model: ";
+		errorMessage.append(name);
+		errorMessage.append("\n\n");
+		errorMessage.append("Received the following warning(s): ");
+		errorMessage.append(warn);
+		throw std::invalid_argument(errorMessage.c_str());
+	}
+	return data;
+}
+
+Lightmap::Mesh StaticBatch::ReadMesh(tinygltf::Model& data, std::string name)
+{
+	const tinygltf::Primitive& primitiveData = data.meshes[0].primitives[0];
+	if (primitiveData.attributes.count("POSITION") == 0
+		|| primitiveData.attributes.count("NORMAL") == 0)
+	{
+		std::string errorMessage;
+		errorMessage.append("The model \"");
+		errorMessage.append(name);
+		errorMessage.append("\" could not be batched, it needs positions and normals");
+		throw std::exception(errorMessage.c_str());
+	}
+
+	tinygltf::Accessor& positionAccessor = data.accessors[primitiveData.attributes.at("POSITION")];
+	tinygltf::Accessor& normalAccessor = data.accessors[primitiveData.attributes.at("NORMAL")];
+	if (positionAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT
+		|| normalAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+	{
+		std::string errorMessage;
+		errorMessage.append("The model \"");
+		errorMessage.append(name);
+		errorMessage.append("\" could not be batched, only float vertex attributes are supported");
+		throw std::exception(errorMessage.c_str());
+	}
+	GLTFData positions(data, positionAccessor);
+	GLTFData normals(data, normalAccessor);
+
+	Lightmap::Mesh mesh;
+	for (size_t i = 0; i < positionAccessor.count; i++)
+	{
+		mesh.positions.push_back(*positions.GetElement<glm::vec3>(i));
+		mesh.normals.push_back(*normals.GetElement<glm::vec3>(i));
+	}
+
+	tinygltf::Accessor& indexAccessor = data.accessors[primitiveData.indices];
+	GLTFData partIndices(data, indexAccessor);
+	for (size_t i = 0; i < indexAccessor.count; i++)
+	{
+		switch (indexAccessor.componentType)
+		{
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			mesh.indices.push_back(*partIndices.GetElement<unsigned char>(i));
+			break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+			mesh.indices.push_back(*partIndices.GetElement<unsigned short>(i));
+			break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+			mesh.indices.push_back(*partIndices.GetElement<unsigned int>(i));
+			break;
+		}
+	}
+	return mesh;
+}
+
+void StaticBatch::UploadInstances(const BatchData& batch, const std::vector<InstanceData>& instances, StreamBuffer& streamBuffer)
+{
+	StreamBuffer::Range range = streamBuffer.Upload(instances.data(), instances.size() * sizeof(InstanceData));
+
+	//The vao keeps pointing at this range until the next upload, which only happens after the pass has been executed
+	GlState::BindVertexArray(batch.vao);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.GetBuffer());
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(instanceAttribLocation + i,
+			4,
+			GL_FLOAT,
+			GL_FALSE,
+			sizeof(InstanceData),
+			(char*)0 + range.offset + i * sizeof(glm::vec4));
+	}
+	glVertexAttribIPointer(faceMaskAttribLocation,
+		1,
+		GL_INT,
+		sizeof(InstanceData),
+		(char*)0 + range.offset + offsetof(InstanceData, faceMask));
+	GlState::BindVertexArray(0);
+}
\ No newline at end of file
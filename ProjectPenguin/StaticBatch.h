@@ -0,0 +1,105 @@
+#pragma once
+
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#include "tiny_gltf.h"
+#include "glm/glm.hpp"
+
+#include <unordered_map>
+
+#include "Shader.h"
+#include "RenderQueue.h"
+#include "EliMath.h"
+#include "Light.h"
+#include "StreamBuffer.h"
+#include "TextureArrayPool.h"
+#include "Lightmap.h"
+
+class Camera;
+
+/*WARNING: Just like Model, this class will leak memory, it's only meant for scenery that lives as long as the game.*/
+
+//Merges the meshes of several static models into one vertex and index buffer at load time.
+//Parts that share a shader and texture size are drawn with a single draw call, their textures are stored in the
+//texture array pool. Shaders used by a batch are compiled with the TEXTURE_ARRAY define.
+//Lightmapped parts get the lights passed to the batch baked into a lightmap, their shaders also get the LIGHTMAP define.
+class StaticBatch
+{
+public:
+	struct Part
+	{
+		std::string modelName;
+		std::string vertexShader;
+		std::string fragShader;
+		bool lightmapped = false;
+	};
+private:
+	struct InstanceData
+	{
+		glm::mat4 modelTransform;
+		int faceMask = Light::allFaces;	//Shadow cube map faces this instance is drawn to, only used by the shadow pass
+	};
+	struct Vertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 texcoord;
+		float layer;	//Layer of the texture array
+		glm::vec3 lightmapTexcoord = glm::vec3(0.0f);	//The layer of the lightmap array is stored in z
+	};
+	//Range of the index buffer that is drawn with the same shader and texture array
+	struct Group
+	{
+		const Shader* shader = nullptr;
+		unsigned int textureArray = 0;
+		unsigned int firstIndex = 0;
+		size_t nIndices = 0;
+		EliMath::AABB bounds;
+		EliMath::BoundingSphere boundingSphere;
+		bool visible = false;	//Whether any queued instance can see this group
+	};
+	struct BatchData
+	{
+		//Geometry, shared by all groups
+		unsigned int vao = 0;
+		size_t nIndices = 0;
+		uint64_t geometryHash = 0;	//Hash of the positions and indices of every part, so baked shadows notice when a model file changes
+		std::vector<Group> groups;
+		EliMath::BoundingSphere boundingSphere;
+
+		//Queue of model transforms for all instances of this batch
+		std::vector<InstanceData> renderQueue;
+	};
+public:
+	StaticBatch(std::string name, const glm::mat4& ownerTransform, const std::vector<Part>& parts, const Lightmap::Lights& bakedLights = Lightmap::Lights());
+
+	void AddToRenderQueue(Camera& camera);
+	static void SubmitInstances(RenderQueue& renderQueue, StreamBuffer& streamBuffer);
+	static void SubmitShadowCasters(RenderQueue& renderQueue, Light& light, StreamBuffer& streamBuffer);
+
+	std::vector<const Shader*> GetShaders() const;	//Every shader used by this batch, once
+
+	//Bakes the lightmaps of the lightmapped parts into the cache without touching the GPU
+	static void BakeLightmaps(const std::vector<Part>& parts, const Lightmap::Lights& bakedLights);
+private:
+	static BatchData& ConstructBatchData(std::string name, const std::vector<Part>& parts, const Lightmap::Lights& bakedLights);
+	static tinygltf::Model LoadModel(std::string name);
+	static Lightmap::Mesh ReadMesh(tinygltf::Model& data, std::string name);
+	static void UploadInstances(const BatchData& batch, const std::vector<InstanceData>& instances, StreamBuffer& streamBuffer);
+private:
+	//Same attribute locations as Model, the texture layer takes the location that animated models use for joints
+	static constexpr unsigned int layerAttribLocation = 3;
+	static constexpr unsigned int lightmapAttribLocation = 4;
+	static constexpr unsigned int instanceAttribLocation = 5;
+	static constexpr unsigned int faceMaskAttribLocation = 10;
+
+	//Reference to owner transform
+	const glm::mat4& ownerTransform;
+
+	static std::unordered_map<std::string, BatchData> existingBatches;
+	BatchData& batchData;
+	static std::vector<InstanceData> shadowCasters;	//Scratch space, reused every frame
+	static const Shader* depthPrepassShader;	//Same program as Model uses, the vertex layouts match
+	//The lightmaps of all parts are layers of one texture array that stays bound, so only one batch can have lightmaps
+	static unsigned int lightmapArray;
+	static constexpr int lightmapTextureUnit = 2;
+};
\ No newline at end of file
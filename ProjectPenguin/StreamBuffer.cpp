@@ -0,0 +1,168 @@
+#include "StreamBuffer.h"
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cassert>
+
+#include "GlGetError.h"
+#include "GlState.h"
+#include "GlCapabilities.h"
+
+StreamBuffer::StreamBuffer(size_t frameSize)
+	:
+	frameSize(frameSize)
+{
+	const size_t totalSize = frameSize * nFrames;
+
+	//GL 3.3 only guarantees 65536 texels, drivers normally allow far more but the texture buffer has to cover the whole ring
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	const size_t nTexels = totalSize / 16;
+	if (nTexels > (size_t)maxTexels)
+	{
+		std::stringstream errorMessage;
+		errorMessage << "The stream buffer needs a texture buffer of " << nTexels << " texels, but the driver only supports "
+			<< maxTexels;
+		throw std::exception(errorMessage.str().c_str());
+	}
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	//Use persistent mapping when possible, fall back to orphaning
+	if (GlCapabilities::HasBufferStorage())
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GlCapabilities::BufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+		mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags);
+	}
+	if (!mapped)
+	{
+		std::cout << "Persistent buffer mapping is not supported, streaming through glBufferSubData instead" << std::endl;
+		glBufferData(GL_ARRAY_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenTextures(1, &texture);
+	GlState::BindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+	GlState::BindTexture(GL_TEXTURE_BUFFER, 0);
+	GL_ERROR_CHECK();
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (void* fence : fences)
+	{
+		if (fence)
+		{
+			glDeleteSync((GLsync)fence);
+		}
+	}
+	if (mapped)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	GlState::DeleteTexture(texture);
+	glDeleteBuffers(1, &buffer);
+}
+
+void StreamBuffer::BeginFrame()
+{
+	currentFrame = (currentFrame + 1) % nFrames;
+	head = 0;
+
+	if (mapped)
+	{
+		//Wait until the GPU has finished the frame that last used this region, normally it already has
+		GLsync fence = (GLsync)fences[currentFrame];
+		if (fence)
+		{
+			GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			while (result == GL_TIMEOUT_EXPIRED)
+			{
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			}
+			glDeleteSync(fence);
+			fences[currentFrame] = nullptr;
+		}
+	}
+	else if (currentFrame == 0)
+	{
+		//Orphan the whole ring, the driver hands out fresh storage while the GPU finishes reading the old one
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, frameSize * nFrames, nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	GL_ERROR_CHECK();
+}
+
+void StreamBuffer::EndFrame()
+{
+	if (mapped)
+	{
+		fences[currentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
+
+StreamBuffer::Range StreamBuffer::Allocate(size_t size, size_t alignment)
+{
+	assert(alignment > 0);
+	//Align the offset from the start of the buffer, so it can be turned into an element index (e.g. a base instance)
+	const size_t regionStart = currentFrame * frameSize;
+	size_t start = (regionStart + head + alignment - 1) / alignment * alignment - regionStart;
+	if (start + size > frameSize)
+	{
+		std::stringstream errorMessage;
+		errorMessage << "The stream buffer ran out of space, " << start + size << " bytes were needed this frame but only "
+			<< frameSize << " are available";
+		throw std::exception(errorMessage.str().c_str());
+	}
+	head = start + size;
+
+	Range result;
+	result.offset = regionStart + start;
+	result.size = size;
+	return result;
+}
+
+void StreamBuffer::Write(const Range& range, const void* data) const
+{
+	if (mapped)
+	{
+		memcpy((char*)mapped + range.offset, data, range.size);
+	}
+	else
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferSubData(GL_ARRAY_BUFFER, range.offset, range.size, data);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+StreamBuffer::Range StreamBuffer::Upload(const void* data, size_t size, size_t alignment)
+{
+	Range range = Allocate(size, alignment);
+	Write(range, data);
+	return range;
+}
+
+unsigned int StreamBuffer::GetBuffer() const
+{
+	return buffer;
+}
+
+unsigned int StreamBuffer::GetTexture() const
+{
+	return texture;
+}
+
+bool StreamBuffer::IsPersistent() const
+{
+	return mapped != nullptr;
+}
\ No newline at end of file
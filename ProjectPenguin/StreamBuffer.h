@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+//Ring buffer for data that's written by the CPU every frame and read by the GPU in that same frame.
+//It's split into one region per frame in flight, every frame allocates its data from the next region.
+//Uses a persistently mapped buffer when GL_ARB_buffer_storage is available, with a fence per region so a region
+//is only overwritten once the GPU is done with it. Otherwise the buffer is orphaned whenever the ring wraps around.
+class StreamBuffer
+{
+public:
+	//Sub range of the buffer, offsets are in bytes from the start of the buffer
+	struct Range
+	{
+		size_t offset = 0;
+		size_t size = 0;
+	};
+public:
+	StreamBuffer(size_t frameSize);
+	~StreamBuffer();
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer operator=(const StreamBuffer&) = delete;
+	StreamBuffer(StreamBuffer&& rhs) = delete;
+	StreamBuffer operator=(StreamBuffer&& rhs) = delete;
+
+	//Allocations are only valid between these calls, EndFrame has to come after the last draw that reads them
+	void BeginFrame();
+	void EndFrame();
+
+	Range Allocate(size_t size, size_t alignment);
+	void Write(const Range& range, const void* data) const;
+	Range Upload(const void* data, size_t size, size_t alignment = 16);	//Allocate and Write in one go
+
+	unsigned int GetBuffer() const;
+	unsigned int GetTexture() const;	//The entire buffer as an RGBA32F texture buffer, one texel per 16 bytes. Construction fails if the driver can't fit it
+	bool IsPersistent() const;
+private:
+	static constexpr int nFrames = 3;	//Regions in the ring, the GPU may lag behind by this many frames
+	const size_t frameSize;
+
+	unsigned int buffer = 0;
+	unsigned int texture = 0;
+	void* mapped = nullptr;	//Only used when the buffer is persistently mapped
+	void* fences[nFrames] = {};	//GLsync objects, only used when the buffer is persistently mapped
+
+	int currentFrame = nFrames - 1;
+	size_t head = 0;	//First free byte in the current region, relative to its start
+};
\ No newline at end of file
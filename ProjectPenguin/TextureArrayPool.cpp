@@ -0,0 +1,203 @@
+#include "TextureArrayPool.h"
+
+#include <glad/glad.h>
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "EliMath.h"
+#include "GlGetError.h"
+#include "GlState.h"
+
+//Static members
+std::map<std::pair<int, TextureBuilder::Format>, TextureArrayPool::TextureArray> TextureArrayPool::textureArrays;
+std::unordered_map<uint64_t, TextureArrayPool::Layer> TextureArrayPool::existingLayers;
+
+TextureArrayPool::Layer TextureArrayPool::Add(const tinygltf::Image& image, std::string name, bool emissiveKeys)
+{
+	//Models often share a texture, those share a layer too. The emissive mask changes the texels, so it gets its own layer
+	uint64_t hash = EliMath::HashBytes(image.image.data(), image.image.size(),
+		EliMath::HashBytes(&image.width, sizeof(int), EliMath::HashBytes(&image.height, sizeof(int))));
+	hash = EliMath::HashBytes(&emissiveKeys, sizeof(bool), hash);
+	auto existing = existingLayers.find(hash);
+	if (existing != existingLayers.end())
+	{
+		return existing->second;
+	}
+
+	int layerSize = GetLayerSize(image);
+	std::vector<unsigned char> pixels = ResizeImage(image, layerSize, name);
+	if (emissiveKeys)
+	{
+		TextureBuilder::MarkEmissiveTexels(pixels);
+	}
+	TextureBuilder::Texture texture = TextureBuilder::Build(pixels, layerSize, layerSize, name);
+
+	TextureArray& textureArray = textureArrays[std::make_pair(layerSize, texture.format)];
+	textureArray.layers.push_back(std::move(texture));
+	if ((int)textureArray.layers.size() > textureArray.capacity)
+	{
+		Grow(textureArray, layerSize);
+	}
+	else
+	{
+		UploadLayer(textureArray, textureArray.layers.size() - 1);
+	}
+
+	Layer newLayer;
+	newLayer.textureArray = textureArray.texture;
+	newLayer.layerSize = layerSize;
+	newLayer.layer = (float)(textureArray.layers.size() - 1);
+
+	existingLayers[hash] = newLayer;
+	return newLayer;
+}
+
+bool TextureArrayPool::UsesEmissiveKeys(const std::string& fragShader)
+{
+	return fragShader == "Surroundings.frag";
+}
+
+int TextureArrayPool::GetLayerSize(const tinygltf::Image& image)
+{
+	return 1 << (int)std::round(std::log2((float)std::max(image.width, image.height)));
+}
+
+std::vector<unsigned char> TextureArrayPool::ResizeImage(const tinygltf::Image& image, int size, std::string name)
+{
+	if ((image.bits != 8 && image.bits != 16) || image.component < 1 || image.component > 4)
+	{
+		std::string errorMessage;
+		errorMessage.append("The texture for ");
+		errorMessage.append(name);
+		errorMessage.append(" could not be loaded, only 8 and 16 bit textures with 1 to 4 components are supported");
+		throw std::exception(errorMessage.c_str());
+	}
+
+	//Read a texel as RGBA in the range of 0 to 255, missing components are filled in like OpenGL does
+	auto Texel = [&image](int x, int y)
+	{
+		size_t texelIndex = ((size_t)y * image.width + x) * image.component;
+		glm::vec4 result(0.0f, 0.0f, 0.0f, 255.0f);
+		for (int i = 0; i < image.component; i++)
+		{
+			if (image.bits == 8)
+			{
+				result[i] = image.image[texelIndex + i];
+			}
+			else
+			{
+				const unsigned short* texel = reinterpret_cast<const unsigned short*>(image.image.data()) + texelIndex;
+				result[i] = texel[i] / 257.0f;
+			}
+		}
+		return result;
+	};
+
+	//Bilinear resize, textures are only ever scaled to the nearest power of two, so this doesn't need to be fancy
+	std::vector<unsigned char> result((size_t)size * size * 4);
+	for (int y = 0; y < size; y++)
+	{
+		float sourceY = glm::clamp((y + 0.5f) * image.height / size - 0.5f, 0.0f, (float)(image.height - 1));
+		int y0 = (int)sourceY;
+		int y1 = std::min(y0 + 1, image.height - 1);
+		float alphaY = sourceY - y0;
+		for (int x = 0; x < size; x++)
+		{
+			float sourceX = glm::clamp((x + 0.5f) * image.width / size - 0.5f, 0.0f, (float)(image.width - 1));
+			int x0 = (int)sourceX;
+			int x1 = std::min(x0 + 1, image.width - 1);
+			float alphaX = sourceX - x0;
+
+			glm::vec4 color = glm::mix(glm::mix(Texel(x0, y0), Texel(x1, y0), alphaX),
+				glm::mix(Texel(x0, y1), Texel(x1, y1), alphaX),
+				alphaY);
+			for (int i = 0; i < 4; i++)
+			{
+				result[((size_t)y * size + x) * 4 + i] = (unsigned char)(color[i] + 0.5f);
+			}
+		}
+	}
+	return result;
+}
+
+void TextureArrayPool::Grow(TextureArray& textureArray, int layerSize)
+{
+	int newCapacity = std::max(textureArray.capacity * 2, initialCapacity);
+	int maxLayers;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	newCapacity = std::min(newCapacity, maxLayers);
+	if (newCapacity < (int)textureArray.layers.size())
+	{
+		std::string errorMessage;
+		errorMessage.append("The texture array for textures of ");
+		errorMessage.append(std::to_string(layerSize));
+		errorMessage.append(" pixels is full, it can only hold ");
+		errorMessage.append(std::to_string(maxLayers));
+		errorMessage.append(" layers");
+		throw std::exception(errorMessage.c_str());
+	}
+
+	if (textureArray.texture == 0)
+	{
+		glGenTextures(1, &textureArray.texture);
+	}
+	GlState::BindTexture(GL_TEXTURE_2D_ARRAY, textureArray.texture);
+
+	//Set texture settings
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	//Keeping the same texture name means models that already use this array don't need to know about the move.
+	//All layers have the same size and format, so they all have the same levels
+	const TextureBuilder::Texture& firstLayer = textureArray.layers.front();
+	GLenum internalFormat = TextureBuilder::GetInternalFormat(firstLayer.format);
+	for (size_t i = 0; i < firstLayer.levels.size(); i++)
+	{
+		const TextureBuilder::Level& level = firstLayer.levels[i];
+		if (TextureBuilder::IsCompressed(firstLayer.format))
+		{
+			size_t levelSize = TextureBuilder::GetLevelSize(firstLayer.format, level.width, level.height);
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, internalFormat, level.width, level.height, newCapacity, 0,
+				(GLsizei)(levelSize * newCapacity), nullptr);
+		}
+		else
+		{
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, internalFormat, level.width, level.height, newCapacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		}
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint)firstLayer.levels.size() - 1);
+	GlState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	textureArray.capacity = newCapacity;
+	GL_ERROR_CHECK();
+
+	for (size_t layer = 0; layer < textureArray.layers.size(); layer++)
+	{
+		UploadLayer(textureArray, layer);
+	}
+}
+
+void TextureArrayPool::UploadLayer(const TextureArray& textureArray, size_t layer)
+{
+	const TextureBuilder::Texture& texture = textureArray.layers[layer];
+	GLenum internalFormat = TextureBuilder::GetInternalFormat(texture.format);
+	GlState::BindTexture(GL_TEXTURE_2D_ARRAY, textureArray.texture);
+	for (size_t i = 0; i < texture.levels.size(); i++)
+	{
+		const TextureBuilder::Level& level = texture.levels[i];
+		if (TextureBuilder::IsCompressed(texture.format))
+		{
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, 0, 0, (GLint)layer, level.width, level.height, 1,
+				internalFormat, (GLsizei)level.data.size(), level.data.data());
+		}
+		else
+		{
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, 0, 0, (GLint)layer, level.width, level.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, level.data.data());
+		}
+	}
+	GlState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	GL_ERROR_CHECK();
+}
\ No newline at end of file
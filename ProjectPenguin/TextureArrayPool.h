@@ -0,0 +1,54 @@
+#pragma once
+
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#include "tiny_gltf.h"
+
+#include "TextureBuilder.h"
+
+#include <map>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+//Base colour textures of all models, stored in one GL_TEXTURE_2D_ARRAY per texture size and format.
+//Textures are resized to the nearest power of two, so models with similar textures end up in the same array
+//and can be drawn without rebinding. Shaders that sample from these arrays are compiled with the TEXTURE_ARRAY define.
+//Layers are mipmapped and compressed by the texture builder.
+class TextureArrayPool
+{
+public:
+	//Where a texture ended up
+	struct Layer
+	{
+		unsigned int textureArray = 0;
+		int layerSize = 0;
+		float layer = 0.0f;
+	};
+public:
+	//Identical images are only stored once. Textures for shaders that light up key colours get an emissive mask, see TextureBuilder::MarkEmissiveTexels
+	static Layer Add(const tinygltf::Image& image, std::string name, bool emissiveKeys = false);
+	static bool UsesEmissiveKeys(const std::string& fragShader);
+
+	static int GetLayerSize(const tinygltf::Image& image);
+	//Resizes the image to size x size RGBA, 8 and 16 bit images with 1 to 4 components are supported
+	static std::vector<unsigned char> ResizeImage(const tinygltf::Image& image, int size, std::string name);
+public:
+	static constexpr const char* defines = "TEXTURE_ARRAY";
+private:
+	struct TextureArray
+	{
+		unsigned int texture = 0;
+		int capacity = 0;
+		//Copies of the uploaded layers, compressed layers are small and this saves reading them back when the array grows
+		std::vector<TextureBuilder::Texture> layers;
+	};
+private:
+	//Reallocates the array with room for more layers and uploads all layers again
+	static void Grow(TextureArray& textureArray, int layerSize);
+	static void UploadLayer(const TextureArray& textureArray, size_t layer);
+private:
+	static constexpr int initialCapacity = 8;
+
+	static std::map<std::pair<int, TextureBuilder::Format>, TextureArray> textureArrays;	//Key is the layer size and format
+	static std::unordered_map<uint64_t, Layer> existingLayers;	//Key is a hash of the image data
+};
\ No newline at end of file
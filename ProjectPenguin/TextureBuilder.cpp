@@ -0,0 +1,394 @@
+#include "TextureBuilder.h"
+
+#include <glad/glad.h>
+#include "glm/glm.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "EliMath.h"
+#include "SaveFile.h"
+#include "GlCapabilities.h"
+#include "GlGetError.h"
+
+//Static members
+const TextureBuilder::EmissiveKey TextureBuilder::emissiveKeys[3] = {
+	{ { 0, 207, 242 }, { 255, 204, 128 } },	//Warm windows
+	{ { 0, 255, 57 }, { 179, 255, 179 } },	//Green lights
+	{ { 2, 0, 255 }, { 255, 179, 179 } }	//Red lights
+};
+
+TextureBuilder::Texture TextureBuilder::Build(const std::vector<unsigned char>& pixels, int width, int height, std::string name)
+{
+	Texture texture;
+	if (!GlCapabilities::HasTextureCompression())
+	{
+		texture.levels = GenerateMipChain(pixels, width, height);
+		return texture;
+	}
+
+	//BC3 spends twice the memory of BC1 on the alpha channel, so it's only used when there is alpha
+	bool hasAlpha = false;
+	for (size_t i = 3; i < pixels.size() && !hasAlpha; i += 4)
+	{
+		hasAlpha = pixels[i] < 255;
+	}
+	texture.format = hasAlpha ? Format::BC3 : Format::BC1;
+
+	//The cache is keyed by the source, so changed textures are compressed again automatically
+	int properties[3] = { width, height, (int)texture.format };
+	uint64_t key = EliMath::HashBytes(pixels.data(), pixels.size(), EliMath::HashBytes(properties, sizeof(properties)));
+	std::stringstream fileName;
+	fileName << "TextureCache_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+	if (LoadFromCache(fileName.str(), key, texture))
+	{
+		return texture;
+	}
+
+	std::cout << "Compressing the texture for " << name << std::endl;
+	for (const Level& level : GenerateMipChain(pixels, width, height))
+	{
+		texture.levels.push_back(Compress(level, texture.format));
+	}
+	SaveToCache(fileName.str(), key, texture);
+	return texture;
+}
+
+void TextureBuilder::Upload2D(const Texture& texture)
+{
+	GLenum internalFormat = GetInternalFormat(texture.format);
+	for (size_t i = 0; i < texture.levels.size(); i++)
+	{
+		const Level& level = texture.levels[i];
+		if (IsCompressed(texture.format))
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, level.width, level.height, 0, (GLsizei)level.data.size(), level.data.data());
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data.data());
+		}
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
+	GL_ERROR_CHECK();
+}
+
+bool TextureBuilder::IsCompressed(Format format)
+{
+	return format != Format::RGBA8;
+}
+
+unsigned int TextureBuilder::GetInternalFormat(Format format)
+{
+	switch (format)
+	{
+	case Format::BC1:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case Format::BC3:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	default:
+		return GL_RGBA8;
+	}
+}
+
+size_t TextureBuilder::GetLevelSize(Format format, int width, int height)
+{
+	if (!IsCompressed(format))
+	{
+		return (size_t)width * height * 4;
+	}
+	//Partial blocks at the edges still take up a whole block
+	size_t nBlocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+	return nBlocks * (format == Format::BC1 ? bc1BlockSize : bc3BlockSize);
+}
+
+std::vector<TextureBuilder::Level> TextureBuilder::GenerateMipChain(const std::vector<unsigned char>& pixels, int width, int height)
+{
+	std::vector<Level> levels;
+	levels.push_back({ width, height, pixels });
+
+	//Box filter, every texel is the average of the 2x2 texels above it
+	while (levels.back().width > 1 || levels.back().height > 1)
+	{
+		const Level& previous = levels.back();
+		Level next;
+		next.width = std::max(previous.width / 2, 1);
+		next.height = std::max(previous.height / 2, 1);
+		next.data.resize((size_t)next.width * next.height * 4);
+		for (int y = 0; y < next.height; y++)
+		{
+			int y0 = std::min(y * 2, previous.height - 1);
+			int y1 = std::min(y * 2 + 1, previous.height - 1);
+			for (int x = 0; x < next.width; x++)
+			{
+				int x0 = std::min(x * 2, previous.width - 1);
+				int x1 = std::min(x * 2 + 1, previous.width - 1);
+				for (int i = 0; i < 4; i++)
+				{
+					int sum = previous.data[((size_t)y0 * previous.width + x0) * 4 + i]
+						+ previous.data[((size_t)y0 * previous.width + x1) * 4 + i]
+						+ previous.data[((size_t)y1 * previous.width + x0) * 4 + i]
+						+ previous.data[((size_t)y1 * previous.width + x1) * 4 + i];
+					next.data[((size_t)y * next.width + x) * 4 + i] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+		levels.push_back(std::move(next));
+	}
+	return levels;
+}
+
+void TextureBuilder::MarkEmissiveTexels(std::vector<unsigned char>& pixels)
+{
+	for (size_t i = 0; i < pixels.size(); i += 4)
+	{
+		pixels[i + 3] = 255;
+		for (const EmissiveKey& emissiveKey : emissiveKeys)
+		{
+			if (std::equal(emissiveKey.key, emissiveKey.key + 3, &pixels[i]))
+			{
+				std::copy_n(emissiveKey.glow, 3, &pixels[i]);
+				pixels[i + 3] = 0;
+				break;
+			}
+		}
+	}
+}
+
+TextureBuilder::Level TextureBuilder::Compress(const Level& level, Format format)
+{
+	Level result;
+	result.width = level.width;
+	result.height = level.height;
+	result.data.resize(GetLevelSize(format, level.width, level.height));
+
+	int nBlocksX = (level.width + 3) / 4;
+	int nBlocksY = (level.height + 3) / 4;
+	size_t blockSize = format == Format::BC1 ? bc1BlockSize : bc3BlockSize;
+	unsigned char texels[16 * 4];
+	for (int blockY = 0; blockY < nBlocksY; blockY++)
+	{
+		for (int blockX = 0; blockX < nBlocksX; blockX++)
+		{
+			//Blocks that stick out of the image repeat the edge texels
+			for (int y = 0; y < 4; y++)
+			{
+				int sourceY = std::min(blockY * 4 + y, level.height - 1);
+				for (int x = 0; x < 4; x++)
+				{
+					int sourceX = std::min(blockX * 4 + x, level.width - 1);
+					std::copy_n(&level.data[((size_t)sourceY * level.width + sourceX) * 4], 4, &texels[(y * 4 + x) * 4]);
+				}
+			}
+
+			unsigned char* block = &result.data[((size_t)blockY * nBlocksX + blockX) * blockSize];
+			if (format == Format::BC3)
+			{
+				//BC3 is a BC1 colour block preceded by an alpha block
+				CompressAlphaBlock(texels, block);
+				CompressColorBlock(texels, block + 8);
+			}
+			else
+			{
+				CompressColorBlock(texels, block);
+			}
+		}
+	}
+	return result;
+}
+
+void TextureBuilder::CompressColorBlock(const unsigned char* texels, unsigned char* output)
+{
+	auto ToRGB565 = [](glm::vec3 color)
+	{
+		int r = (int)(color.r * 31.0f / 255.0f + 0.5f);
+		int g = (int)(color.g * 63.0f / 255.0f + 0.5f);
+		int b = (int)(color.b * 31.0f / 255.0f + 0.5f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	};
+	auto FromRGB565 = [](uint16_t color)
+	{
+		int r = (color >> 11) & 31;
+		int g = (color >> 5) & 63;
+		int b = color & 31;
+		return glm::vec3((float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)));
+	};
+
+	//The endpoints are the corners of the bounding box of the colours, pulled in a little because the corners are rarely hit
+	glm::vec3 minColor(255.0f);
+	glm::vec3 maxColor(0.0f);
+	for (int i = 0; i < 16; i++)
+	{
+		glm::vec3 color(texels[i * 4], texels[i * 4 + 1], texels[i * 4 + 2]);
+		minColor = glm::min(minColor, color);
+		maxColor = glm::max(maxColor, color);
+	}
+	glm::vec3 inset = (maxColor - minColor) / 16.0f;
+	uint16_t color0 = ToRGB565(maxColor - inset);
+	uint16_t color1 = ToRGB565(minColor + inset);
+
+	//color0 has to be the larger one, otherwise the block is decoded with 3 colours and transparent black
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		glm::vec3 palette[4];
+		palette[0] = FromRGB565(color0);
+		palette[1] = FromRGB565(color1);
+		palette[2] = (2.0f * palette[0] + palette[1]) / 3.0f;
+		palette[3] = (palette[0] + 2.0f * palette[1]) / 3.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			glm::vec3 color(texels[i * 4], texels[i * 4 + 1], texels[i * 4 + 2]);
+			uint32_t best = 0;
+			float bestDistance = std::numeric_limits<float>::max();
+			for (uint32_t j = 0; j < 4; j++)
+			{
+				glm::vec3 difference = color - palette[j];
+				float distance = glm::dot(difference, difference);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = j;
+				}
+			}
+			indices |= best << (2 * i);
+		}
+	}
+
+	//Little endian
+	output[0] = (unsigned char)(color0 & 0xFF);
+	output[1] = (unsigned char)(color0 >> 8);
+	output[2] = (unsigned char)(color1 & 0xFF);
+	output[3] = (unsigned char)(color1 >> 8);
+	for (int i = 0; i < 4; i++)
+	{
+		output[4 + i] = (unsigned char)(indices >> (8 * i));
+	}
+}
+
+void TextureBuilder::CompressAlphaBlock(const unsigned char* texels, unsigned char* output)
+{
+	int minAlpha = 255;
+	int maxAlpha = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		minAlpha = std::min(minAlpha, (int)texels[i * 4 + 3]);
+		maxAlpha = std::max(maxAlpha, (int)texels[i * 4 + 3]);
+	}
+
+	//With alpha0 > alpha1 there are 6 values in between the endpoints
+	uint64_t indices = 0;
+	if (maxAlpha > minAlpha)
+	{
+		float palette[8];
+		palette[0] = (float)maxAlpha;
+		palette[1] = (float)minAlpha;
+		for (int i = 1; i < 7; i++)
+		{
+			palette[i + 1] = ((7 - i) * maxAlpha + i * minAlpha) / 7.0f;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			uint64_t best = 0;
+			float bestDistance = std::numeric_limits<float>::max();
+			for (uint64_t j = 0; j < 8; j++)
+			{
+				float distance = std::abs((float)texels[i * 4 + 3] - palette[j]);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = j;
+				}
+			}
+			indices |= best << (3 * i);
+		}
+	}
+
+	output[0] = (unsigned char)maxAlpha;
+	output[1] = (unsigned char)minAlpha;
+	for (int i = 0; i < 6; i++)
+	{
+		output[2 + i] = (unsigned char)(indices >> (8 * i));
+	}
+}
+
+bool TextureBuilder::LoadFromCache(std::string fileName, uint64_t key, Texture& texture)
+{
+	if (!SaveFile::FileExists(fileName))
+	{
+		return false;
+	}
+
+	std::string filePath = "UserData/";
+	filePath.append(fileName);
+	std::ifstream file(filePath, std::ios::binary);
+
+	//Header: version, key and format all have to match
+	uint32_t version = 0;
+	uint64_t storedKey = 0;
+	uint32_t format = 0;
+	uint32_t nLevels = 0;
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+	file.read(reinterpret_cast<char*>(&format), sizeof(format));
+	file.read(reinterpret_cast<char*>(&nLevels), sizeof(nLevels));
+	if (!file || version != cacheVersion || storedKey != key || format != (uint32_t)texture.format || nLevels == 0 || nLevels > 32)
+	{
+		std::cout << "Cached texture " << fileName << " is out of date" << std::endl;
+		return false;
+	}
+
+	std::vector<Level> levels(nLevels);
+	for (Level& level : levels)
+	{
+		int32_t size[2] = { 0, 0 };
+		file.read(reinterpret_cast<char*>(size), sizeof(size));
+		if (!file || size[0] <= 0 || size[1] <= 0)
+		{
+			break;
+		}
+		level.width = size[0];
+		level.height = size[1];
+		level.data.resize(GetLevelSize(texture.format, level.width, level.height));
+		file.read(reinterpret_cast<char*>(level.data.data()), level.data.size());
+	}
+
+	if (!file)
+	{
+		std::cout << "Cached texture " << fileName << " is incomplete" << std::endl;
+		return false;
+	}
+	texture.levels = std::move(levels);
+	return true;
+}
+
+void TextureBuilder::SaveToCache(std::string fileName, uint64_t key, const Texture& texture)
+{
+	std::string filePath = "UserData/";
+	filePath.append(fileName);
+	std::ofstream file(filePath, std::ios::binary);
+
+	uint32_t version = cacheVersion;
+	uint32_t format = (uint32_t)texture.format;
+	uint32_t nLevels = (uint32_t)texture.levels.size();
+	file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+	file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+	file.write(reinterpret_cast<const char*>(&nLevels), sizeof(nLevels));
+	for (const Level& level : texture.levels)
+	{
+		int32_t size[2] = { level.width, level.height };
+		file.write(reinterpret_cast<const char*>(size), sizeof(size));
+		file.write(reinterpret_cast<const char*>(level.data.data()), level.data.size());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Turns base colour images into textures that are cheap to sample: a full mip chain, compressed to BC1 (opaque)
+//or BC3 (with alpha). Drivers without S3TC get uncompressed RGBA8 mips instead.
+//Compressing is slow, so compressed textures are cached in UserData, keyed by a hash of the source pixels.
+class TextureBuilder
+{
+public:
+	enum class Format
+	{
+		RGBA8 = 0,
+		BC1,
+		BC3
+	};
+	struct Level
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> data;
+	};
+	struct Texture
+	{
+		Format format = Format::RGBA8;
+		std::vector<Level> levels;	//Level 0 is the full image
+	};
+public:
+	//Expects tightly packed RGBA8 pixels, name is only used for error messages
+	static Texture Build(const std::vector<unsigned char>& pixels, int width, int height, std::string name);
+	//Uploads every level to the GL_TEXTURE_2D that is currently bound
+	static void Upload2D(const Texture& texture);
+
+	static bool IsCompressed(Format format);
+	static unsigned int GetInternalFormat(Format format);	//The GL enum, RGBA8 is GL_RGBA8
+	static size_t GetLevelSize(Format format, int width, int height);	//In bytes
+
+	static std::vector<Level> GenerateMipChain(const std::vector<unsigned char>& pixels, int width, int height);
+	static Level Compress(const Level& level, Format format);
+
+	//Texels of the emissive key colours (the windows and lamps of the surroundings) get the colour they glow with,
+	//alpha becomes how much a texel doesn't glow. Unlike exact colours this survives compression and mipmapping.
+	//Alpha of every other texel becomes opaque
+	static void MarkEmissiveTexels(std::vector<unsigned char>& pixels);
+private:
+	struct EmissiveKey
+	{
+		unsigned char key[3];
+		unsigned char glow[3];
+	};
+private:
+	//Blocks are 4x4 texels, read as 16 RGBA texels
+	static void CompressColorBlock(const unsigned char* texels, unsigned char* output);
+	static void CompressAlphaBlock(const unsigned char* texels, unsigned char* output);
+
+	static bool LoadFromCache(std::string fileName, uint64_t key, Texture& texture);
+	static void SaveToCache(std::string fileName, uint64_t key, const Texture& texture);
+private:
+	static constexpr uint32_t cacheVersion = 1;	//Increase whenever the output of the builder changes
+	static constexpr size_t bc1BlockSize = 8;
+	static constexpr size_t bc3BlockSize = 16;
+	static const EmissiveKey emissiveKeys[3];
+};
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "UIAtlas.h"
+
+#include <glad/glad.h>
+#include "stb_image.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <sstream>
+#include <cassert>
+
+#include "GlGetError.h"
+#include "GlState.h"
+
+//Static members
+bool UIAtlas::preloaded = false;
+unsigned int UIAtlas::texture = 0;
+std::unordered_map<std::string, UIAtlas::Region> UIAtlas::regions;
+
+void UIAtlas::PreLoad()
+{
+	if (preloaded)
+	{
+		return;
+	}
+	preloaded = true;
+
+	//Every texture the UI elements use, the particle textures are loaded by ParticleSystem
+	const std::vector<std::string> textureNames = {
+		"DefaultButton.png",
+		"Logo.png",
+		"NewPersonalBest.png",
+		"Numbers.png",
+		"PenguinWarningRed.png",
+		"PenguinWarningYellow.png",
+		"PersonalBest.png",
+		"Quit.png",
+		"Resume.png",
+		"Retry.png",
+		"ScoreLine.png",
+		"ScoreScreen.png",
+		"Start.png",
+		"Tutorial.png"
+	};
+
+	//Load all images first, packing needs their sizes
+	std::vector<unsigned char*> images;
+	std::vector<glm::ivec2> sizes;
+	stbi_set_flip_vertically_on_load(true);
+	for (const std::string& textureName : textureNames)
+	{
+		std::string texturePath = "UI/";
+		texturePath.append(textureName);
+		int width, height, nrChannels;
+		unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 4);
+		if (!data)
+		{
+			for (unsigned char* image : images)
+			{
+				stbi_image_free(image);
+			}
+			stbi_set_flip_vertically_on_load(false);
+			std::string errorMessage = "The UI texture ";
+			errorMessage.append(texturePath);
+			errorMessage.append(" could not be loaded");
+			throw std::exception(errorMessage.c_str());
+		}
+		images.push_back(data);
+		sizes.emplace_back(width, height);
+	}
+	stbi_set_flip_vertically_on_load(false);
+
+	int atlasHeight = 0;
+	std::vector<glm::ivec2> positions = PackShelves(sizes, atlasWidth, padding, atlasHeight);
+
+	//Copy the images into one block of memory, the empty space stays transparent
+	std::vector<unsigned char> atlasData((size_t)atlasWidth * (size_t)atlasHeight * 4, 0);
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		for (int row = 0; row < sizes[i].y; row++)
+		{
+			size_t target = ((size_t)(positions[i].y + row) * (size_t)atlasWidth + (size_t)positions[i].x) * 4;
+			memcpy(&atlasData[target], images[i] + (size_t)row * (size_t)sizes[i].x * 4, (size_t)sizes[i].x * 4);
+		}
+		stbi_image_free(images[i]);
+
+		Region& region = regions[textureNames[i]];
+		region.min = glm::vec2(positions[i]) / glm::vec2((float)atlasWidth, (float)atlasHeight);
+		region.max = glm::vec2(positions[i] + sizes[i]) / glm::vec2((float)atlasWidth, (float)atlasHeight);
+	}
+
+	//Generate texture
+	glGenTextures(1, &texture);
+	GlState::BindTexture(GL_TEXTURE_2D, texture);
+
+	//Set texture settings
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlasWidth, atlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlasData.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GlState::BindTexture(GL_TEXTURE_2D, 0);
+	GL_ERROR_CHECK();
+}
+
+const UIAtlas::Region& UIAtlas::GetRegion(const std::string& textureName)
+{
+	assert(preloaded);
+	auto it = regions.find(textureName);
+	if (it == regions.end())
+	{
+		std::string errorMessage = "The UI texture ";
+		errorMessage.append(textureName);
+		errorMessage.append(" is not part of the UI atlas");
+		throw std::exception(errorMessage.c_str());
+	}
+	return it->second;
+}
+
+unsigned int UIAtlas::GetTexture()
+{
+	return texture;
+}
+
+std::vector<glm::ivec2> UIAtlas::PackShelves(const std::vector<glm::ivec2>& sizes, int atlasWidth, int padding, int& atlasHeight)
+{
+	struct Shelf
+	{
+		int y;
+		int height;
+		int usedWidth;
+	};
+
+	//Tallest first, so every shelf is as tall as the first image placed on it
+	std::vector<size_t> order(sizes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+		[&sizes](size_t lhs, size_t rhs)
+		{
+			return sizes[lhs].y > sizes[rhs].y;
+		});
+
+	std::vector<glm::ivec2> positions(sizes.size());
+	std::vector<Shelf> shelves;
+	atlasHeight = 0;
+	for (size_t index : order)
+	{
+		const glm::ivec2 size = sizes[index];
+		if (size.x > atlasWidth)
+		{
+			std::stringstream errorMessage;
+			errorMessage << "An image of " << size.x << " pixels wide doesn't fit in an atlas of " << atlasWidth << " pixels wide";
+			throw std::exception(errorMessage.str().c_str());
+		}
+
+		auto shelf = std::find_if(shelves.begin(), shelves.end(),
+			[&size, atlasWidth](const Shelf& candidate)
+			{
+				return size.y <= candidate.height && candidate.usedWidth + size.x <= atlasWidth;
+			});
+		if (shelf == shelves.end())
+		{
+			shelves.push_back({ atlasHeight, size.y, 0 });
+			atlasHeight += size.y + padding;
+			shelf = shelves.end() - 1;
+		}
+
+		positions[index] = glm::ivec2(shelf->usedWidth, shelf->y);
+		shelf->usedWidth += size.x + padding;
+	}
+	return positions;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+//All UI textures packed into a single texture, so a whole canvas can be drawn with one texture bound.
+//Images are packed on shelves: sorted by height, each goes on the first shelf it fits on, or on a new one.
+class UIAtlas
+{
+public:
+	//Where an image ended up, in texture coordinates of the atlas
+	struct Region
+	{
+		glm::vec2 min = glm::vec2(0.0f);
+		glm::vec2 max = glm::vec2(0.0f);
+	};
+public:
+	static void PreLoad();	//Loads and packs the textures the first time it's called
+	static const Region& GetRegion(const std::string& textureName);
+	static unsigned int GetTexture();
+
+	//Returns the bottom left corner of each rectangle, atlasHeight is set to the height the shelves take up
+	static std::vector<glm::ivec2> PackShelves(const std::vector<glm::ivec2>& sizes, int atlasWidth, int padding, int& atlasHeight);
+private:
+	static constexpr int atlasWidth = 2048;
+	static constexpr int padding = 2;	//Empty texels between images, so linear filtering doesn't pick up the neighbours
+
+	static bool preloaded;
+	static unsigned int texture;
+	static std::unordered_map<std::string, Region> regions;
+};
\ No newline at end of file
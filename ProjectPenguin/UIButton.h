@@ -1,23 +1,23 @@
 #pragma once
 
-#include "Shader.h"
+#include "glm/glm.hpp"
+
+#include "UIAtlas.h"
+
+#include <string>
 
 class Input;
 class AudioSource;
+class UISpriteBatch;
 
 class UIButton
 {
 public:
 	UIButton(float left, float top, float right, float bottom, glm::vec2 relativeTopLeft, glm::vec2 relativeBottomRight, std::string textureName, AudioSource& buttonQuacker);
-	~UIButton();
-	UIButton(const UIButton&) = delete;
-	UIButton operator=(const UIButton&) = delete;
-	UIButton(UIButton&& rhs) noexcept;
-	UIButton operator=(UIButton&& rhs) = delete;
 
 	void UpdateSize(float newLeft, float newTop, float newRight, float newBottom);
 	bool UpdateAndCheckClick(const Input& input);
-	void Draw();
+	void Draw(UISpriteBatch& batch) const;
 
 	void SetOnColor(glm::vec3 newColor);
 	void SetOffColor(glm::vec3 newColor);
@@ -29,16 +29,8 @@ public:
 	float GetTop() const;
 	float GetBottom() const;
 private:
-	//Geometry
-	unsigned int vao = 0;
-	unsigned int vbo;
-	unsigned int ebo;
-
-	//Shader
-	Shader shader;
-
-	//Texture
-	unsigned int texture = 0;
+	//Texture, part of the UI atlas
+	UIAtlas::Region region;
 
 	//Dimensions
 	const glm::vec2 relativeTopLeft;	//Relative to MenuCanvas
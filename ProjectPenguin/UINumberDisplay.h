@@ -1,8 +1,14 @@
 #pragma once
 
-#include "Shader.h"
+#include "glm/glm.hpp"
+
+#include "UIAtlas.h"
+
+#include <string>
+#include <vector>
 
 class Input;
+class UISpriteBatch;
 
 enum class Anchor
 {
@@ -15,29 +21,17 @@ class UINumberDisplay
 {
 public:
 	UINumberDisplay(glm::vec2 pos, glm::vec2 letterScale, Anchor anchor, glm::vec2 relativePos, glm::vec2 relativeLetterScale, std::string textureName = "Numbers.png");
-	~UINumberDisplay();
-	UINumberDisplay(const UINumberDisplay&) = delete;
-	UINumberDisplay operator=(const UINumberDisplay&) = delete;
-	UINumberDisplay(UINumberDisplay&& rhs) noexcept;
-	UINumberDisplay operator=(UINumberDisplay&& rhs) = delete;
 
 	void UpdateSize(glm::vec2 newPos, glm::vec2 newScale);
 	void SetNumber(unsigned int value);
-	void Draw();
+	void Draw(UISpriteBatch& batch) const;
 
 	glm::vec2 GetRelativePos() const;
 	glm::vec2 GetRelativeScale() const;
 private:
-	//Geometry
-	unsigned int vao = 0;
-	unsigned int vbo;
-	unsigned int ebo;
-
-	//Shader
-	Shader shader;
-
-	//Texture
-	unsigned int texture = 0;
+	//Texture, part of the UI atlas. The digits 0 to 9 are side by side
+	UIAtlas::Region region;
+	static constexpr int nDigits = 10;
 
 	//Dimensions
 	const glm::vec2 relativePos;	//Relative to MenuCanvas
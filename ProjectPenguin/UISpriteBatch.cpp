@@ -0,0 +1,92 @@
+#include "UISpriteBatch.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+#include "GlGetError.h"
+#include "GlState.h"
+
+//Static members
+bool UISpriteBatch::graphicsInitialised = false;
+unsigned int UISpriteBatch::vao = 0;
+unsigned int UISpriteBatch::vbo = 0;
+std::unique_ptr<Shader> UISpriteBatch::shader;
+
+UISpriteBatch::UISpriteBatch()
+{
+	if (!graphicsInitialised)
+	{
+		InitGraphics();
+	}
+}
+
+void UISpriteBatch::AddQuad(glm::vec2 bottomLeft, glm::vec2 topRight, const UIAtlas::Region& region, glm::vec3 color)
+{
+	const Vertex topRightVertex = { topRight, region.max, color };
+	const Vertex bottomRightVertex = { glm::vec2(topRight.x, bottomLeft.y), glm::vec2(region.max.x, region.min.y), color };
+	const Vertex bottomLeftVertex = { bottomLeft, region.min, color };
+	const Vertex topLeftVertex = { glm::vec2(bottomLeft.x, topRight.y), glm::vec2(region.min.x, region.max.y), color };
+
+	//Same winding as the quads the elements used to draw themselves
+	vertices.push_back(topLeftVertex);
+	vertices.push_back(bottomRightVertex);
+	vertices.push_back(topRightVertex);
+	vertices.push_back(topLeftVertex);
+	vertices.push_back(bottomLeftVertex);
+	vertices.push_back(bottomRightVertex);
+}
+
+void UISpriteBatch::Draw()
+{
+	if (vertices.empty())
+	{
+		return;
+	}
+
+	GlState::ActiveTexture(0);
+	GlState::BindTexture(GL_TEXTURE_2D, UIAtlas::GetTexture());
+	shader->Use();
+
+	GlState::BindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STREAM_DRAW);
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+	GlState::BindVertexArray(0);
+	GL_ERROR_CHECK();
+
+	vertices.clear();
+}
+
+size_t UISpriteBatch::GetNumQuads() const
+{
+	return vertices.size() / 6;
+}
+
+void UISpriteBatch::InitGraphics()
+{
+	graphicsInitialised = true;
+
+	shader = std::make_unique<Shader>("UISprite.vert", "UISprite.frag");
+	shader->Use();
+	shader->SetUniformInt("texture0", 0);
+
+	//Generate VAO
+	glGenVertexArrays(1, &vao);
+	GlState::BindVertexArray(vao);
+
+	//Generate VBO, it's filled every draw
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+	//Set up attributes
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texcoord));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+	glEnableVertexAttribArray(2);
+
+	GlState::BindVertexArray(0);
+	GL_ERROR_CHECK();
+}
\ No newline at end of file
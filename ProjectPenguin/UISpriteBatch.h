@@ -0,0 +1,40 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "Shader.h"
+#include "UIAtlas.h"
+
+#include <memory>
+#include <vector>
+
+//Collects the quads of a UI canvas and draws them all at once, every quad samples from the UI atlas.
+//Positions are in normalized device coordinates.
+class UISpriteBatch
+{
+private:
+	struct Vertex
+	{
+		glm::vec2 position;
+		glm::vec2 texcoord;
+		glm::vec3 color;
+	};
+public:
+	UISpriteBatch();
+
+	void AddQuad(glm::vec2 bottomLeft, glm::vec2 topRight, const UIAtlas::Region& region, glm::vec3 color = glm::vec3(1.0f));
+	//Draws and clears all quads added since the last call, in the order they were added
+	void Draw();
+
+	size_t GetNumQuads() const;
+private:
+	static void InitGraphics();
+private:
+	//Shared by all batches, the buffer is orphaned every draw
+	static bool graphicsInitialised;
+	static unsigned int vao;
+	static unsigned int vbo;
+	static std::unique_ptr<Shader> shader;
+
+	std::vector<Vertex> vertices;	//Six per quad
+};
\ No newline at end of file
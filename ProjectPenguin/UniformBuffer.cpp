@@ -0,0 +1,58 @@
+#include "UniformBuffer.h"
+
+#include <sstream>
+#include <cassert>
+
+#include <glad/glad.h>
+
+#include "GlGetError.h"
+
+UniformBuffer::UniformBuffer(UniformBlock block, size_t size)
+	:
+	size(size),
+	block(block)
+{
+	glGenBuffers(1, &ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+	glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	Bind();
+	GL_ERROR_CHECK();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	if (ubo > 0)
+	{
+		glDeleteBuffers(1, &ubo);
+	}
+}
+
+void UniformBuffer::Update(const void* data, size_t dataSize, size_t offset) const
+{
+	assert(offset + dataSize <= size);
+	glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, dataSize, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffer::Bind() const
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, (GLuint)block, ubo);
+}
+
+const char* UniformBuffer::GetBlockName(UniformBlock block)
+{
+	switch (block)
+	{
+	case UniformBlock::FrameConstants:
+		return "FrameConstants";
+	case UniformBlock::LightConstants:
+		return "LightConstants";
+	case UniformBlock::ShadowMatrices:
+		return "ShadowMatrices";
+	case UniformBlock::SimpleLights:
+		return "SimpleLights";
+	}
+	return "";
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+//Binding points of the uniform blocks that are shared by multiple shaders.
+//Shader binds blocks with these names to their binding point after linking.
+enum class UniformBlock : unsigned int
+{
+	FrameConstants = 0,
+	LightConstants,
+	ShadowMatrices,
+	SimpleLights,
+	Count
+};
+
+//std140 layouts, these have to match the uniform blocks in the shaders
+struct FrameConstants
+{
+	glm::mat4 viewProjection;
+	glm::vec3 cameraPos;
+	float padding = 0.0f;
+};
+
+struct LightConstants
+{
+	glm::vec3 lightPos;
+	float lightFarPlane;	//vec3 followed by a float is packed into 16 bytes
+};
+
+struct ShadowMatrices
+{
+	glm::mat4 shadowMatrices[6];
+};
+
+struct SimpleLights
+{
+	static constexpr int maxLights = 64;	//Has to match MAX_SIMPLE_LIGHTS in the shaders
+
+	glm::vec4 lights[maxLights];	//xyz is the position, every element of an array is padded to 16 bytes anyway
+	glm::vec3 gridMin;
+	float cellSize;
+	glm::ivec3 gridSize;
+	int nLights;
+	float lightRadius;
+	int nBakedLights;	//The first lights are in the lightmaps of lightmapped meshes already
+	float padding[2] = {};
+};
+
+class UniformBuffer
+{
+public:
+	UniformBuffer(UniformBlock block, size_t size);
+	~UniformBuffer();
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer operator=(const UniformBuffer&) = delete;
+	UniformBuffer(UniformBuffer&& rhs) = delete;
+	UniformBuffer operator=(UniformBuffer&& rhs) = delete;
+
+	void Update(const void* data, size_t dataSize, size_t offset = 0) const;
+	template<typename T>
+	void Update(const T& data) const
+	{
+		Update(&data, sizeof(T));
+	}
+	void Bind() const;
+
+	static const char* GetBlockName(UniformBlock block);
+private:
+	unsigned int ubo = 0;
+	const size_t size;
+	const UniformBlock block;
+};
\ No newline at end of file
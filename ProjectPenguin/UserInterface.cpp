@@ -1,5 +1,7 @@
 #include "UserInterface.h"
 
+#include "GlState.h"
+
 UICanvas::UICanvas(const Window& window, AudioManager& audioManager, float aspectRatio)
 	:
 	window(window),
@@ -10,7 +12,7 @@ UICanvas::UICanvas(const Window& window, AudioManager& audioManager, float aspec
 {
 	buttonQuacker.SetFollowListener(true);
 	buttonQuacker.SetVolume(0.05f);
-	PenguinWarning::PreLoad();
+	UIAtlas::PreLoad();
 }
 
 void UICanvas::AddButton(glm::vec2 topLeft, glm::vec2 bottomRight, std::string name, std::string textureName)
@@ -115,31 +117,31 @@ void UICanvas::Update()
 void UICanvas::Draw()
 {
 	//Turn on blending
-	glEnable(GL_BLEND);
-	glDisable(GL_DEPTH_TEST);
-	//Loop through all UI elements and draw
+	GlState::Enable(GL_BLEND);
+	GlState::Disable(GL_DEPTH_TEST);
+	//Loop through all UI elements and add them to the batch
 	for (std::pair<const std::string, UIButton>& button : buttons)
 	{
 		if (!std::count(hiddenElements.begin(), hiddenElements.end(), button.first))
 		{
-			button.second.Draw();
+			button.second.Draw(spriteBatch);
 		}
 	}
 	for (std::pair<const std::string, UINumberDisplay>& numberDisplay : numberDisplays)
 	{
 		if (!std::count(hiddenElements.begin(), hiddenElements.end(), numberDisplay.first))
 		{
-			numberDisplay.second.Draw();
+			numberDisplay.second.Draw(spriteBatch);
 		}
 	}
-	PenguinWarning::BindGraphics();
 	for (PenguinWarning& pw : penguinWarnings)
 	{
-		pw.Draw();
+		pw.Draw(spriteBatch);
 	}
+	spriteBatch.Draw();
 	//Unhide hidden elements
 	hiddenElements.clear();
 	//Turn off blending
-	glDisable(GL_BLEND);
-	glEnable(GL_DEPTH_TEST);
+	GlState::Disable(GL_BLEND);
+	GlState::Enable(GL_DEPTH_TEST);
 }
\ No newline at end of file
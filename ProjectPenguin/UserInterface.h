@@ -3,6 +3,7 @@
 #include "UIButton.h"
 #include "UINumberDisplay.h"
 #include "PenguinWarning.h"
+#include "UISpriteBatch.h"
 #include "Window.h"
 #include "AudioSource.h"
 
@@ -28,7 +29,7 @@ public:
 	//Recalculate dimensions based on window aspect ratio
 	void Update();
 
-	//Render all buttons and then clear the canvas
+	//Render all elements in one draw call and then clear the canvas
 	void Draw();
 private:
 	const Window& window;
@@ -40,6 +41,9 @@ private:
 
 	std::vector<std::string> hiddenElements;
 
+	//All elements are added to this every frame
+	UISpriteBatch spriteBatch;
+
 	//Menu dimensions
 	const float aspectRatio;
 	float width;
@@ -6,10 +6,12 @@
 
 #include "Camera.h"
 #include "ScreenQuad.h"
+#include "GlCapabilities.h"
+#include "GlState.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-	glViewport(0, 0, width, height);
+	GlState::Viewport(0, 0, width, height);
 }
 
 Window::Window(int width, int height, std::string name)
@@ -33,9 +35,11 @@ Window::Window(int width, int height, std::string name)
 	//Init glad
 	auto temp = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
 	assert(temp);
+	GlCapabilities::Probe();
+	GlState::Invalidate();
 
 	//Init viewport with same properties as the window
-	glViewport(0, 0, width, height);
+	GlState::Viewport(0, 0, width, height);
 
 	//Make sure that the viewport is automatically resized with the window
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
@@ -50,10 +54,10 @@ Window::Window(int width, int height, std::string name)
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	//Enable backface culling
-	glEnable(GL_CULL_FACE);
+	GlState::Enable(GL_CULL_FACE);
 
 	//Enable depth testing
-	glEnable(GL_DEPTH_TEST);
+	GlState::Enable(GL_DEPTH_TEST);
 }
 
 Window::~Window()
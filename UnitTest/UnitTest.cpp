@@ -7,10 +7,20 @@
 #include "../ProjectPenguin/IceRink.h"
 #include "../ProjectPenguin/Penguin.h"
 #include "../ProjectPenguin/EliMath.h"
+#include "../ProjectPenguin/Camera.h"
 #include "../ProjectPenguin/Spawner.h"
 #include "../ProjectPenguin/UserInterface.h"
 #include "../ProjectPenguin/SaveFile.h"
 #include "../ProjectPenguin/FishingPenguin.h"
+#include "../ProjectPenguin/RenderQueue.h"
+#include "../ProjectPenguin/DynamicResolution.h"
+#include "../ProjectPenguin/GpuProfiler.h"
+#include "../ProjectPenguin/UIAtlas.h"
+#include "../ProjectPenguin/TextureArrayPool.h"
+#include "../ProjectPenguin/TextureBuilder.h"
+#include "../ProjectPenguin/LightClusters.h"
+#include "../ProjectPenguin/Lightmap.h"
+#include "../ProjectPenguin/BlobShadows.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -223,6 +233,48 @@ namespace UnitTest
 			Assert::AreEqual(target.y, result.y, L"The raycast returned an incorrect result");
 			Assert::AreEqual(target.z, result.z, L"The raycast returned an incorrect result");
 		}
+		TEST_METHOD(FrustumCulling)
+		{
+			Camera camera;
+			camera.SetAspectRatio(16.0f / 9.0f);
+			camera.LookAt(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f));
+			camera.CalculateVPMatrix();
+
+			EliMath::BoundingSphere inFront = { glm::vec3(0.0f), 1.0f };
+			EliMath::BoundingSphere behind = { glm::vec3(0.0f, 0.0f, 20.0f), 1.0f };
+			EliMath::BoundingSphere touchingEdge = { glm::vec3(30.0f, 0.0f, 0.0f), 25.0f };
+			EliMath::BoundingSphere offToTheSide = { glm::vec3(30.0f, 0.0f, 0.0f), 1.0f };
+			Assert::IsTrue(camera.IsInView(inFront), L"A sphere in front of the camera was culled");
+			Assert::IsFalse(camera.IsInView(behind), L"A sphere behind the camera was not culled");
+			Assert::IsTrue(camera.IsInView(touchingEdge), L"A sphere overlapping the edge of the view was culled");
+			Assert::IsFalse(camera.IsInView(offToTheSide), L"A sphere next to the view was not culled");
+		}
+		TEST_METHOD(BoundsFromAABB)
+		{
+			EliMath::AABB box;
+			Assert::IsTrue(box.IsEmpty(), L"A new box is not empty");
+			Assert::IsTrue(std::isinf(EliMath::SphereFromAABB(box).radius), L"An empty box should never be culled");
+
+			box.Grow(glm::vec3(-1.0f, 0.0f, -1.0f));
+			box.Grow(glm::vec3(1.0f, 2.0f, 1.0f));
+			glm::mat4 transform(2.0f);
+			transform[3] = glm::vec4(5.0f, 0.0f, 0.0f, 1.0f);
+			EliMath::BoundingSphere sphere = EliMath::TransformSphere(EliMath::SphereFromAABB(box), transform);
+			Assert::AreEqual(5.0f, sphere.center.x, L"The bounding sphere was not moved");
+			Assert::AreEqual(2.0f, sphere.center.y, L"The bounding sphere was not moved");
+			Assert::AreEqual(2.0f * sqrtf(3.0f), sphere.radius, 0.0001f, L"The bounding sphere was not scaled");
+		}
+		TEST_METHOD(ShadowCasterHash)
+		{
+			glm::mat4 transform(1.0f);
+			uint64_t original = EliMath::HashBytes(&transform, sizeof(transform));
+			Assert::IsTrue(original == EliMath::HashBytes(&transform, sizeof(transform)), L"Hashing the same data twice gave different results");
+
+			transform[3].x += 0.001f;
+			Assert::IsTrue(original != EliMath::HashBytes(&transform, sizeof(transform)), L"A moved caster has the same hash");
+			transform[3].x -= 0.001f;
+			Assert::IsTrue(original != EliMath::HashBytes(&transform, sizeof(transform), 1), L"The seed is ignored");
+		}
 	};
 	TEST_CLASS(Spawns)
 	{
@@ -312,4 +364,384 @@ namespace UnitTest
 			Assert::AreEqual(tutorialFinished, load.GetTutorialCompleted(), L"tutorial completed does not match");
 		}
 	};
+	TEST_CLASS(RenderSorting)
+	{
+	public:
+		TEST_METHOD(SortKeyPriority)
+		{
+			//Pass matters most, then program, texture, vao and finally depth
+			uint64_t shadow = RenderQueue::MakeKey(RenderPass::Shadow, 9, 9, 9, 90.0f);
+			uint64_t opaque = RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, 1.0f);
+			Assert::IsTrue(shadow < opaque, L"The shadow pass is not sorted before the opaque pass");
+
+			uint64_t near = RenderQueue::MakeKey(RenderPass::Opaque, 3, 2, 1, 1.0f);
+			uint64_t far = RenderQueue::MakeKey(RenderPass::Opaque, 3, 2, 1, 50.0f);
+			uint64_t otherProgram = RenderQueue::MakeKey(RenderPass::Opaque, 4, 1, 1, 1.0f);
+			Assert::IsTrue(near < far, L"Nearer batches are not sorted first");
+			Assert::IsTrue(far < otherProgram, L"Batches with the same program are not kept together");
+		}
+		TEST_METHOD(FrontToBackKeys)
+		{
+			//Depth comes right after the pass, so the program no longer matters
+			uint64_t nearOtherProgram = RenderQueue::MakeKey(RenderPass::DepthPrepass, 9, 9, 9, 1.0f, true);
+			uint64_t far = RenderQueue::MakeKey(RenderPass::DepthPrepass, 1, 1, 1, 50.0f, true);
+			Assert::IsTrue(nearOtherProgram < far, L"Nearer batches are not sorted first");
+
+			uint64_t prepass = RenderQueue::MakeKey(RenderPass::DepthPrepass, 1, 1, 1, 90.0f, true);
+			uint64_t opaque = RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, 1.0f);
+			Assert::IsTrue(prepass < opaque, L"The depth pre-pass is not sorted before the opaque pass");
+			Assert::IsTrue(RenderPass::DepthPrepass == RenderQueue::GetPass(prepass), L"The pass can't be read back from the key");
+			Assert::IsTrue(RenderPass::Opaque == RenderQueue::GetPass(opaque), L"The pass can't be read back from the key");
+		}
+		TEST_METHOD(RadixSortIsSortedAndStable)
+		{
+			std::vector<RenderQueue::Command> commands;
+			std::vector<uint64_t> keys = { 0xFF00000000000001, 5, 0x0000010000000000, 5, 0, 0xFF00000000000000 };
+			for (unsigned int i = 0; i < keys.size(); i++)
+			{
+				RenderQueue::Command command = {};
+				command.key = keys[i];
+				command.nInstances = i;	//Remember submission order
+				commands.push_back(command);
+			}
+
+			std::vector<RenderQueue::Command> scratch;
+			RenderQueue::RadixSort(commands, scratch);
+
+			for (size_t i = 1; i < commands.size(); i++)
+			{
+				Assert::IsTrue(commands[i - 1].key <= commands[i].key, L"The commands are not sorted");
+			}
+			//The two commands with key 5 must keep their order
+			Assert::AreEqual(1u, commands[1].nInstances, L"The radix sort is not stable");
+			Assert::AreEqual(3u, commands[2].nInstances, L"The radix sort is not stable");
+		}
+	};
+	TEST_CLASS(ResolutionScaling)
+	{
+	public:
+		TEST_METHOD(SlowFramesLowerTheScale)
+		{
+			const float target = 1.0f / 60.0f;
+			DynamicResolution resolution(target, 0.5f);
+			for (int i = 0; i < 600; i++)
+			{
+				resolution.Update(target * 2.0f);
+			}
+			Assert::AreEqual(0.5f, resolution.GetScale(), L"The scale didn't drop to the minimum");
+		}
+		TEST_METHOD(OnTimeFramesRestoreTheScale)
+		{
+			const float target = 1.0f / 60.0f;
+			DynamicResolution resolution(target, 0.5f);
+			for (int i = 0; i < 600; i++)
+			{
+				resolution.Update(target * 2.0f);
+			}
+			//A single slow frame shouldn't stop the scale from recovering
+			for (int i = 0; i < 60 * 60; i++)
+			{
+				resolution.Update(i == 1000 ? target * 3.0f : target);
+			}
+			Assert::AreEqual(1.0f, resolution.GetScale(), L"The scale didn't go back up");
+		}
+	};
+	TEST_CLASS(Profiling)
+	{
+	public:
+		TEST_METHOD(RollingPassTimings)
+		{
+			GpuProfiler profiler;
+			for (int i = 0; i < 1000; i++)
+			{
+				profiler.AddSample("Shadows", i == 10 ? 8.0f : 2.0f);
+			}
+			const GpuProfiler::PassTimings& shadows = profiler.GetTimings().at("Shadows");
+			Assert::AreEqual(1000u, shadows.nSamples, L"Samples went missing");
+			Assert::AreEqual(8.0f, shadows.maxMs, L"The slowest sample wasn't kept");
+			Assert::AreEqual(2.0f, shadows.averageMs, 0.01f, L"The average didn't settle");
+			Assert::IsTrue(shadows.history.size() < 1000, L"The history isn't bounded");
+		}
+	};
+	TEST_CLASS(UIAtlasPacking)
+	{
+	public:
+		TEST_METHOD(ShelvesDontOverlap)
+		{
+			std::vector<glm::ivec2> sizes = { {500, 200}, {1000, 40}, {64, 64}, {2048, 10}, {700, 300}, {900, 200}, {128, 512} };
+			const int atlasWidth = 2048;
+			const int padding = 2;
+			int atlasHeight = 0;
+			std::vector<glm::ivec2> offsets = UIAtlas::PackShelves(sizes, atlasWidth, padding, atlasHeight);
+			Assert::AreEqual(sizes.size(), offsets.size(), L"Not every image was placed");
+			for (size_t i = 0; i < sizes.size(); i++)
+			{
+				Assert::IsTrue(offsets[i].x >= 0 && offsets[i].y >= 0, L"Image placed outside the atlas");
+				Assert::IsTrue(offsets[i].x + sizes[i].x <= atlasWidth, L"Image sticks out of the side of the atlas");
+				Assert::IsTrue(offsets[i].y + sizes[i].y <= atlasHeight, L"Image sticks out of the top of the atlas");
+				for (size_t j = i + 1; j < sizes.size(); j++)
+				{
+					bool separate = offsets[i].x + sizes[i].x <= offsets[j].x || offsets[j].x + sizes[j].x <= offsets[i].x
+						|| offsets[i].y + sizes[i].y <= offsets[j].y || offsets[j].y + sizes[j].y <= offsets[i].y;
+					Assert::IsTrue(separate, L"Two images overlap");
+				}
+			}
+		}
+		TEST_METHOD(TooWideImageThrows)
+		{
+			int atlasHeight = 0;
+			Assert::ExpectException<std::exception>([&]() { UIAtlas::PackShelves({ {4096, 16} }, 2048, 2, atlasHeight); });
+		}
+	};
+	TEST_CLASS(TextureArrays)
+	{
+	public:
+		TEST_METHOD(LayerSizeRoundsToPowerOfTwo)
+		{
+			tinygltf::Image image;
+			image.width = 600;
+			image.height = 300;
+			Assert::AreEqual(512, TextureArrayPool::GetLayerSize(image), L"Wrong layer size");
+			image.width = 200;
+			image.height = 1000;
+			Assert::AreEqual(1024, TextureArrayPool::GetLayerSize(image), L"Wrong layer size");
+		}
+		TEST_METHOD(ResizeFillsMissingComponents)
+		{
+			//A single grey texel, read as RGBA and scaled up
+			tinygltf::Image image;
+			image.width = 1;
+			image.height = 1;
+			image.component = 1;
+			image.bits = 8;
+			image.image = { 100 };
+			std::vector<unsigned char> pixels = TextureArrayPool::ResizeImage(image, 4, "Grey");
+			Assert::AreEqual((size_t)4 * 4 * 4, pixels.size(), L"Wrong number of texels");
+			for (size_t i = 0; i < pixels.size(); i += 4)
+			{
+				Assert::AreEqual((unsigned char)100, pixels[i], L"Red was changed");
+				Assert::AreEqual((unsigned char)0, pixels[i + 1], L"Missing green wasn't zero");
+				Assert::AreEqual((unsigned char)0, pixels[i + 2], L"Missing blue wasn't zero");
+				Assert::AreEqual((unsigned char)255, pixels[i + 3], L"Missing alpha wasn't opaque");
+			}
+		}
+	};
+	TEST_CLASS(TextureCompression)
+	{
+	public:
+		TEST_METHOD(MipChainGoesDownToOneTexel)
+		{
+			std::vector<unsigned char> pixels((size_t)8 * 4 * 4);
+			for (size_t i = 0; i < pixels.size(); i += 4)
+			{
+				pixels[i] = 200;
+				pixels[i + 1] = 100;
+				pixels[i + 2] = 50;
+				pixels[i + 3] = 255;
+			}
+			std::vector<TextureBuilder::Level> levels = TextureBuilder::GenerateMipChain(pixels, 8, 4);
+			Assert::AreEqual((size_t)4, levels.size(), L"Wrong number of mip levels");
+			Assert::AreEqual(2, levels[2].width, L"Wrong mip width");
+			Assert::AreEqual(1, levels[2].height, L"Wrong mip height");
+			Assert::AreEqual((unsigned char)100, levels.back().data[1], L"Averaging changed a uniform image");
+		}
+		TEST_METHOD(BlockSizes)
+		{
+			Assert::AreEqual((size_t)8, TextureBuilder::GetLevelSize(TextureBuilder::Format::BC1, 2, 2), L"Partial blocks should take a whole block");
+			Assert::AreEqual((size_t)64, TextureBuilder::GetLevelSize(TextureBuilder::Format::BC3, 8, 8), L"Wrong BC3 size");
+			Assert::AreEqual((size_t)256, TextureBuilder::GetLevelSize(TextureBuilder::Format::RGBA8, 8, 8), L"Wrong RGBA8 size");
+		}
+		TEST_METHOD(SolidBlockIsExact)
+		{
+			TextureBuilder::Level level;
+			level.width = 4;
+			level.height = 4;
+			for (int i = 0; i < 16; i++)
+			{
+				level.data.insert(level.data.end(), { 255, 0, 0, 255 });
+			}
+			TextureBuilder::Level compressed = TextureBuilder::Compress(level, TextureBuilder::Format::BC1);
+			std::vector<unsigned char> expected = { 0x00, 0xF8, 0x00, 0xF8, 0, 0, 0, 0 };
+			Assert::IsTrue(expected == compressed.data, L"Pure red should be stored exactly");
+		}
+		TEST_METHOD(AlphaEndpointsAreKept)
+		{
+			TextureBuilder::Level level;
+			level.width = 4;
+			level.height = 4;
+			for (int i = 0; i < 16; i++)
+			{
+				unsigned char alpha = i < 8 ? 0 : 255;
+				level.data.insert(level.data.end(), { 255, 255, 255, alpha });
+			}
+			TextureBuilder::Level compressed = TextureBuilder::Compress(level, TextureBuilder::Format::BC3);
+			Assert::AreEqual((size_t)16, compressed.data.size(), L"Wrong block size");
+			Assert::AreEqual((unsigned char)255, compressed.data[0], L"Wrong first alpha endpoint");
+			Assert::AreEqual((unsigned char)0, compressed.data[1], L"Wrong second alpha endpoint");
+			//The first 8 texels use index 1 (alpha 0), the last 8 use index 0 (alpha 255)
+			uint64_t indices = 0;
+			for (int i = 0; i < 6; i++)
+			{
+				indices |= (uint64_t)compressed.data[2 + i] << (8 * i);
+			}
+			for (int i = 0; i < 16; i++)
+			{
+				Assert::AreEqual(i < 8 ? (uint64_t)1 : (uint64_t)0, (indices >> (3 * i)) & 7, L"Texel got the wrong alpha");
+			}
+		}
+		TEST_METHOD(EmissiveKeysSurviveCompression)
+		{
+			//The key colours of the surroundings and the colour they glow with
+			const unsigned char keys[3][3] = { { 0, 207, 242 }, { 0, 255, 57 }, { 2, 0, 255 } };
+			const glm::vec3 glows[3] = { glm::vec3(255, 204, 128), glm::vec3(179, 255, 179), glm::vec3(255, 179, 179) };
+			for (int k = 0; k < 3; k++)
+			{
+				TextureBuilder::Level level;
+				level.width = 4;
+				level.height = 4;
+				for (int i = 0; i < 16; i++)
+				{
+					level.data.insert(level.data.end(), { keys[k][0], keys[k][1], keys[k][2], 255 });
+				}
+				TextureBuilder::MarkEmissiveTexels(level.data);
+				TextureBuilder::Level compressed = TextureBuilder::Compress(level, TextureBuilder::Format::BC3);
+
+				//A solid block decodes to its alpha and colour endpoints
+				Assert::AreEqual((unsigned char)0, compressed.data[0], L"Key colour should glow fully");
+				Assert::AreEqual((unsigned char)0, compressed.data[1], L"Key colour should glow fully");
+				int color = compressed.data[8] | (compressed.data[9] << 8);
+				int r = (color >> 11) & 31;
+				int g = (color >> 5) & 63;
+				int b = color & 31;
+				glm::vec3 decoded((float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)));
+				for (int i = 0; i < 3; i++)
+				{
+					Assert::AreEqual(glows[k][i], decoded[i], 8.0f, L"Glow colour changed too much");
+				}
+			}
+		}
+		TEST_METHOD(EmissiveMaskSurvivesMipmapping)
+		{
+			//One window texel next to three wall texels, the wall's alpha should be ignored
+			std::vector<unsigned char> pixels = {
+				0, 207, 242, 255,	100, 100, 100, 128,
+				100, 100, 100, 255,	100, 100, 100, 255
+			};
+			TextureBuilder::MarkEmissiveTexels(pixels);
+			Assert::AreEqual((unsigned char)255, pixels[7], L"Alpha of other texels should become opaque");
+			std::vector<TextureBuilder::Level> levels = TextureBuilder::GenerateMipChain(pixels, 2, 2);
+			Assert::AreEqual((unsigned char)191, levels.back().data[3], L"A quarter of the texel should glow");
+		}
+	};
+	TEST_CLASS(LightClustering)
+	{
+	public:
+		TEST_METHOD(LightsOnlyReachNearbyCells)
+		{
+			LightClusters clusters(1.0f);
+			clusters.Build({ glm::vec3(0.0f), glm::vec3(10.0f, 0.0f, 0.0f) });
+			Assert::AreEqual(12, clusters.GetGridSize().x, L"Grid should span both lights and their radius");
+
+			int nearFirst = clusters.GetCellIndex(glm::vec3(0.5f, 0.5f, 0.5f));
+			Assert::IsTrue(std::vector<int>{ 0 } == clusters.GetLightsInCell(nearFirst), L"Only the first light should reach it");
+			int nearSecond = clusters.GetCellIndex(glm::vec3(9.5f, -0.5f, 0.5f));
+			Assert::IsTrue(std::vector<int>{ 1 } == clusters.GetLightsInCell(nearSecond), L"Only the second light should reach it");
+			int between = clusters.GetCellIndex(glm::vec3(5.5f, 0.0f, 0.0f));
+			Assert::IsTrue(clusters.GetLightsInCell(between).empty(), L"No light reaches the middle");
+			Assert::AreEqual(-1, clusters.GetCellIndex(glm::vec3(20.0f, 0.0f, 0.0f)), L"Should be outside of the grid");
+		}
+		TEST_METHOD(OverlappingLightsShareCells)
+		{
+			LightClusters clusters(1.0f);
+			clusters.Build({ glm::vec3(0.0f), glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(-0.5f, 0.0f, 0.0f) });
+			std::vector<int> lights = clusters.GetLightsInCell(clusters.GetCellIndex(glm::vec3(0.1f)));
+			Assert::IsTrue(std::vector<int>{ 0, 1, 2 } == lights, L"All lights should be listed in order");
+		}
+		TEST_METHOD(TooManyLightsThrows)
+		{
+			LightClusters clusters(1.0f);
+			std::vector<glm::vec3> lights(SimpleLights::maxLights + 1, glm::vec3(0.0f));
+			Assert::ExpectException<std::exception>([&]() { clusters.Build(lights); });
+		}
+	};
+	TEST_CLASS(Lightmapping)
+	{
+	public:
+		//Two lit triangles next to a light and one far away from it
+		Lightmap::Mesh MakeMesh()
+		{
+			Lightmap::Mesh mesh;
+			mesh.positions = { glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f),
+				glm::vec3(50.0f, 0.0f, 0.0f), glm::vec3(51.0f, 0.0f, 0.0f), glm::vec3(50.0f, 0.0f, 1.0f) };
+			mesh.normals.assign(mesh.positions.size(), glm::vec3(0.0f, 1.0f, 0.0f));
+			mesh.indices = { 0, 1, 2, 2, 1, 3, 4, 5, 6 };
+			return mesh;
+		}
+		TEST_METHOD(LitTrianglesGetSeparateCells)
+		{
+			Lightmap::Lights lights;
+			lights.positions.emplace_back(0.5f, 1.0f, 0.5f);
+			Lightmap::Unwrapped unwrapped = Lightmap::Unwrap(MakeMesh(), lights);
+
+			Assert::AreEqual((size_t)9, unwrapped.vertexRemap.size(), L"Every corner should get its own vertex");
+			Assert::AreEqual(2u, unwrapped.vertexRemap[3], L"Copies should point at the original vertex");
+			Assert::IsTrue(unwrapped.cells[0].z > 0 && unwrapped.cells[1].z > 0, L"Triangles near the light need texels");
+			Assert::AreEqual(0, unwrapped.cells[2].z, L"Triangles out of reach share the black cell");
+			glm::ivec3 a = unwrapped.cells[0];
+			glm::ivec3 b = unwrapped.cells[1];
+			bool overlap = a.x < b.x + b.z && b.x < a.x + a.z && a.y < b.y + b.z && b.y < a.y + a.z;
+			Assert::IsFalse(overlap, L"Cells overlap");
+		}
+		TEST_METHOD(BakeMatchesEvaluate)
+		{
+			Lightmap::Lights lights;
+			lights.positions.emplace_back(0.5f, 1.0f, 0.5f);
+			Lightmap::Mesh mesh = MakeMesh();
+			Lightmap::Unwrapped unwrapped = Lightmap::Unwrap(mesh, lights);
+			std::vector<unsigned char> pixels = Lightmap::Bake(mesh, unwrapped, lights);
+
+			//The texel at the first corner of the first triangle
+			glm::ivec2 texel = glm::ivec2(unwrapped.texcoords[0] * (float)Lightmap::resolution);
+			float expected = Lightmap::Evaluate(mesh.positions[0], mesh.normals[0], lights) / Lightmap::maxIntensity;
+			float baked = (float)pixels[(size_t)texel.y * Lightmap::resolution + (size_t)texel.x] / 255.0f;
+			Assert::AreEqual(expected, baked, 0.05f, L"Baked intensity is off");
+			glm::ivec2 dark = glm::ivec2(unwrapped.texcoords[6] * (float)Lightmap::resolution);
+			Assert::AreEqual((unsigned char)0, pixels[(size_t)dark.y * Lightmap::resolution + (size_t)dark.x], L"Unlit triangles should be black");
+		}
+		TEST_METHOD(FalloffMatchesShader)
+		{
+			Lightmap::Lights lights;
+			lights.positions.emplace_back(0.0f, 1.0f, 0.0f);
+			lights.radius = 3.0f;
+			//(3 - 1) / 3 falloff times a dot product of 1
+			Assert::AreEqual(2.0f / 3.0f, Lightmap::Evaluate(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), lights), 0.0001f);
+			Assert::AreEqual(0.0f, Lightmap::Evaluate(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f), lights), L"Faces pointing away are dark");
+			Assert::AreEqual(0.0f, Lightmap::Evaluate(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), lights), L"Out of reach");
+		}
+	};
+	TEST_CLASS(BlobShadowing)
+	{
+	public:
+		TEST_METHOD(HigherObjectsCastSmallerBlobs)
+		{
+			BlobShadows blobShadows(glm::vec2(0.0f), glm::vec2(10.0f));
+			blobShadows.Add(glm::vec3(1.0f, 0.0f, 1.0f));
+			blobShadows.Add(glm::vec3(1.0f, 5.0f, 1.0f));
+			blobShadows.Add(glm::vec3(1.0f, 12.0f, 1.0f));
+			Assert::AreEqual((size_t)2, blobShadows.GetNumBlobs(), L"Objects far above the ground shouldn't cast a blob");
+			Assert::IsTrue(blobShadows.GetRadius(1) < blobShadows.GetRadius(0), L"Higher objects should cast smaller blobs");
+		}
+		TEST_METHOD(AreaMapsToTextureCoordinates)
+		{
+			BlobShadows blobShadows(glm::vec2(2.0f, -1.0f), glm::vec2(4.0f, 2.0f));
+			glm::vec4 area = blobShadows.GetArea();
+			//Same mapping as IceShader.frag
+			glm::vec2 minCorner = (glm::vec2(-2.0f, -3.0f) - glm::vec2(area)) / glm::vec2(area.z, area.w) + 0.5f;
+			glm::vec2 maxCorner = (glm::vec2(6.0f, 1.0f) - glm::vec2(area)) / glm::vec2(area.z, area.w) + 0.5f;
+			Assert::AreEqual(0.0f, minCorner.x, 0.0001f, L"Wrong bottom left corner");
+			Assert::AreEqual(0.0f, minCorner.y, 0.0001f, L"Wrong bottom left corner");
+			Assert::AreEqual(1.0f, maxCorner.x, 0.0001f, L"Wrong top right corner");
+			Assert::AreEqual(1.0f, maxCorner.y, 0.0001f, L"Wrong top right corner");
+		}
+	};
 }